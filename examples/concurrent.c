@@ -0,0 +1,108 @@
+#include <stdio.h>
+#include <pthread.h>
+
+#define SBV_IMPLEMENTATION
+#include "../sbv.h"
+
+// several writers append numbered records to one sb_concurrent_t while the main thread drains it
+// every drained chunk has to hold whole records, and every writer's records have to arrive in order
+
+#define WRITERS 8
+#define RECORDS 50000
+#define SEGMENT_SIZE 4096
+
+static sb_concurrent_t *builder;
+static SBV__ATOMIC(int) finished;
+
+static void* writer(void *arg)
+{
+    long id = (long) arg;
+    char big[2 * SEGMENT_SIZE];
+    memset(big, 'x', sizeof(big));
+
+    for (int i = 0; i < RECORDS; ++i) {
+        // mostly short records, sometimes one that is larger than a whole segment
+        int payload = (i % 997 == 0) ? (int) sizeof(big) - 64 : i % 23;
+        int written;
+        if (i % 2 == 0) {
+            written = sb_concurrent_appendf(builder, "<%ld:%d:%.*s>", id, i, payload, big);
+        } else {
+            char record[sizeof(big)];
+            int len = snprintf(record, sizeof(record), "<%ld:%d:%.*s>", id, i, payload, big);
+            written = sb_concurrent_append(builder, sv_from_slice(record, (size_t) len));
+        }
+        if (written < 0) {
+            fprintf(stderr, "[ERROR] writer %ld could not append record %d\n", id, i);
+            exit(1);
+        }
+    }
+    SBV__ATOMIC_FETCH_ADD(&finished, 1);
+    return NULL;
+}
+
+static int next[WRITERS];
+static size_t records;
+
+// check a drained chunk, it has to consist of complete records only
+static bool check_chunk(sv_t chunk)
+{
+    if (chunk.items[0] != '<' || chunk.items[chunk.len - 1] != '>') {
+        fprintf(stderr, "[ERROR] drained chunk splits a record\n");
+        return false;
+    }
+    SV_FOREACH_SPLIT_CHAR(record, chunk, '>') {
+        if (sv_empty(record)) continue;
+        long id;
+        int seq;
+        if (record.items[0] != '<' || sscanf(record.items + 1, "%ld:%d:", &id, &seq) != 2 || id < 0 || id >= WRITERS) {
+            fprintf(stderr, "[ERROR] malformed record '"SV_PRINT_FORMAT"'\n", SV_PRINT_ARGS(sv_slice(record, 0, 32)));
+            return false;
+        }
+        if (seq != next[id]) {
+            fprintf(stderr, "[ERROR] writer %ld: expected record %d, got %d\n", id, next[id], seq);
+            return false;
+        }
+        next[id] += 1;
+        records += 1;
+    }
+    return true;
+}
+
+int main(void)
+{
+    builder = sb_concurrent_create(SEGMENT_SIZE);
+    if (builder == NULL) {
+        fprintf(stderr, "[ERROR] could not create the builder\n");
+        return 1;
+    }
+
+    pthread_t threads[WRITERS];
+    for (long i = 0; i < WRITERS; ++i) {
+        pthread_create(&threads[i], NULL, writer, (void*) i);
+    }
+
+    // drain while the writers run, and once more after all of them are done
+    bool ok = true;
+    for (;;) {
+        bool done = SBV__ATOMIC_LOAD(&finished) == WRITERS;
+        sv_t chunk;
+        while (ok && !sv_isnull(chunk = sb_concurrent_drain(builder))) {
+            ok = check_chunk(chunk);
+        }
+        if (done || !ok) break;
+    }
+
+    for (int i = 0; i < WRITERS; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+    sb_concurrent_free(builder);
+
+    if (ok && records != (size_t) WRITERS * RECORDS) {
+        fprintf(stderr, "[ERROR] drained %zu records, expected %d\n", records, WRITERS * RECORDS);
+        ok = false;
+    }
+    if (!ok) return 1;
+
+    printf("%d writers appended %zu records, all whole and in order\n", WRITERS, records);
+    return 0;
+}
@@ -0,0 +1,79 @@
+#define _GNU_SOURCE // FNM_CASEFOLD
+#include <stdio.h>
+#include <stdlib.h>
+#include <fnmatch.h>
+
+#define SBV_IMPLEMENTATION
+#include "../sbv.h"
+
+// compare sv_glob_match with fnmatch(3) on random patterns and strings, for every combination of flags
+
+#define ITERATIONS 200000
+
+// pattern pieces, including classes, escapes and unterminated brackets
+static const char *atoms[] = {
+    "a", "b", "A", "/", "*", "?", "[ab]", "[!a]", "[a-c]", "\\*", "ab", "*a*", "[^/]", "[", "[*", "[]a]",
+};
+#define ATOMS_COUNT (sizeof(atoms) / sizeof(atoms[0]))
+
+// pairs that once went wrong
+static const char *regressions[][2] = {
+    {"?[*", "x*"},
+    {"?[*a*?", "]aab/]A"},
+    {"a[b", "a[b"},
+    {"[!", "[!"},
+};
+#define REGRESSIONS_COUNT (sizeof(regressions) / sizeof(regressions[0]))
+
+static size_t pairs;
+
+static bool check(const char *pattern, const char *text)
+{
+    for (int flags = 0; flags < 4; ++flags) {
+        int fnmatch_flags = ((flags & SV_GLOB_CASE) ? FNM_CASEFOLD : 0) | ((flags & SV_GLOB_PATHNAME) ? FNM_PATHNAME : 0);
+        sv_glob_t glob;
+        if (!sv_glob_compile(&glob, sv_from_cstr(pattern), flags)) {
+            fprintf(stderr, "[ERROR] could not compile '%s'\n", pattern);
+            return false;
+        }
+        bool matched = sv_glob_match(&glob, sv_from_cstr(text));
+        bool expected = fnmatch(pattern, text, fnmatch_flags) == 0;
+        sv_glob_free(&glob);
+        if (matched != expected) {
+            fprintf(stderr, "[ERROR] pattern '%s', text '%s', flags %d: got %d, fnmatch says %d\n",
+                    pattern, text, flags, matched, expected);
+            return false;
+        }
+        pairs += 1;
+    }
+    return true;
+}
+
+int main(void)
+{
+    for (size_t i = 0; i < REGRESSIONS_COUNT; ++i) {
+        if (!check(regressions[i][0], regressions[i][1])) return 1;
+    }
+
+    srand(1);
+    const char *alphabet = "abAB/*c][";
+    for (int it = 0; it < ITERATIONS; ++it) {
+        char pattern[256] = {0};
+        int atoms_count = rand() % 8;
+        for (int i = 0; i < atoms_count; ++i) strcat(pattern, atoms[rand() % ATOMS_COUNT]);
+        // now and then a pattern with more than 64 elements
+        if (rand() % 50 == 0) {
+            for (int i = 0; i < 70; ++i) strcat(pattern, rand() % 3 ? "a" : "?");
+        }
+
+        char text[128] = {0};
+        int len = rand() % 12;
+        for (int i = 0; i < len; ++i) text[i] = alphabet[rand() % 9];
+        if (strlen(pattern) > 70 && rand() % 2) memset(text, 'a', 75);
+
+        if (!check(pattern, text)) return 1;
+    }
+
+    printf("sv_glob_match agrees with fnmatch on %zu pattern/text/flags combinations\n", pairs);
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include <stdio.h>
+#include <pthread.h>
+
+// count the live allocations of the library, so the program can tell whether a thread left buffers behind
+#include <stdlib.h>
+static long live_allocations;
+static void* counting_malloc(size_t size)
+{
+    void *p = malloc(size);
+    if (p != NULL) __atomic_fetch_add(&live_allocations, 1, __ATOMIC_RELAXED);
+    return p;
+}
+static void* counting_realloc(void *p, size_t size)
+{
+    void *q = realloc(p, size);
+    if (p == NULL && q != NULL) __atomic_fetch_add(&live_allocations, 1, __ATOMIC_RELAXED);
+    return q;
+}
+static void counting_free(void *p)
+{
+    if (p != NULL) __atomic_fetch_sub(&live_allocations, 1, __ATOMIC_RELAXED);
+    free(p);
+}
+
+#define SBV_MALLOC counting_malloc
+#define SBV_REALLOC counting_realloc
+#define SBV_FREE counting_free
+#define SBV_POOL
+#define SBV_THREADS
+#define SBV_IMPLEMENTATION
+#include "../sbv.h"
+
+// short-lived threads build strings with pooled buffers and exit without calling sb_pool_flush_thread
+// their caches are handed to the shared pool on thread exit, so trimming the pool afterwards frees every buffer
+
+#define ROUNDS 50
+#define THREADS 4
+
+static void* worker(void *arg)
+{
+    long id = (long) arg;
+    for (int i = 0; i < 200; ++i) {
+        sb_t a = sb_pool_acquire(100 + (size_t) i * 37);
+        sb_t b = sb_null();
+        sb_appendf(&a, "thread %ld, string %d", id, i);
+        for (int k = 0; k < i % 50; ++k) sb_append_sv(&b, sv_from_sb(&a));
+        sb_free(&a);
+        sb_free(&b);
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    for (int round = 0; round < ROUNDS; ++round) {
+        pthread_t threads[THREADS];
+        for (long i = 0; i < THREADS; ++i) {
+            pthread_create(&threads[i], NULL, worker, (void*) i);
+        }
+        for (int i = 0; i < THREADS; ++i) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+
+    sb_pool_trim();
+    long live = __atomic_load_n(&live_allocations, __ATOMIC_RELAXED);
+    if (live != 0) {
+        fprintf(stderr, "[ERROR] %ld buffers were left behind by exited threads\n", live);
+        return 1;
+    }
+    printf("%d threads exited without flushing, no buffer was left behind\n", ROUNDS * THREADS);
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <pthread.h>
+
+// count the live allocations of the library, the profile tables are the only ones that outlive a call
+#include <stdlib.h>
+static long live_allocations;
+static void* counting_malloc(size_t size)
+{
+    void *p = malloc(size);
+    if (p != NULL) __atomic_fetch_add(&live_allocations, 1, __ATOMIC_RELAXED);
+    return p;
+}
+static void* counting_realloc(void *p, size_t size)
+{
+    void *q = realloc(p, size);
+    if (p == NULL && q != NULL) __atomic_fetch_add(&live_allocations, 1, __ATOMIC_RELAXED);
+    return q;
+}
+static void counting_free(void *p)
+{
+    if (p != NULL) __atomic_fetch_sub(&live_allocations, 1, __ATOMIC_RELAXED);
+    free(p);
+}
+
+#define SBV_MALLOC counting_malloc
+#define SBV_REALLOC counting_realloc
+#define SBV_FREE counting_free
+#define SBV_PROFILE
+#define SBV_THREADS
+#define SBV_IMPLEMENTATION
+#include "../sbv.h"
+
+// short-lived threads record calls while the main thread keeps writing reports and resetting the profile
+// afterwards the profile is reset once more and has to report exactly the calls made since then
+
+#define ROUNDS 20
+#define THREADS 4
+
+static void* worker(void *arg)
+{
+    long id = (long) arg;
+    sb_t sb = sb_null();
+    for (int i = 0; i < 5000; ++i) {
+        sb_appendf(&sb, "%ld:%d,", id, i);
+        if (sv_contains(sv_from_sb(&sb), sv_from_cstr("99,"))) sb_clear(&sb);
+    }
+    sb_free(&sb);
+    return NULL;
+}
+
+// write a JSON report and read it back
+static sb_t report_json(void)
+{
+    sb_t sb = sb_null();
+    FILE *f = tmpfile();
+    if (f == NULL) return sb;
+    sbv_profile_report_json(f);
+    rewind(f);
+    char buff[4096];
+    size_t n;
+    while ((n = fread(buff, 1, sizeof(buff), f)) > 0) sb_append_slice(&sb, buff, n);
+    fclose(f);
+    return sb;
+}
+
+int main(void)
+{
+    // every site in a report has been called at least once, even while its table is being reset
+    for (int round = 0; round < ROUNDS; ++round) {
+        pthread_t threads[THREADS];
+        for (long i = 0; i < THREADS; ++i) {
+            pthread_create(&threads[i], NULL, worker, (void*) i);
+        }
+        for (int k = 0; k < 10; ++k) {
+            sb_t report = report_json();
+            if (sv_contains(sv_from_sb(&report), sv_from_cstr("\"calls\":0,"))) {
+                fprintf(stderr, "[ERROR] a report contains a site without calls\n");
+                return 1;
+            }
+            sb_free(&report);
+            if (k % 3 == 0) sbv_profile_reset();
+        }
+        for (int i = 0; i < THREADS; ++i) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+
+    // the tables of exited threads are reused, so there is at most one per thread running at once
+    long tables = __atomic_load_n(&live_allocations, __ATOMIC_RELAXED);
+    if (tables > THREADS + 1) {
+        fprintf(stderr, "[ERROR] %ld profile tables for at most %d threads at once\n", tables, THREADS + 1);
+        return 1;
+    }
+
+    sbv_profile_reset();
+    size_t count = 0;
+    for (int i = 0; i < 1000; ++i) count += sv_count_char(sv_from_cstr("a,b,c"), ',');
+    sb_t report = report_json();
+    sv_t json = sv_from_sb(&report);
+    if (count != 2000 || !sv_contains(json, sv_from_cstr("\"function\":\"sv_count_char\"")) ||
+        !sv_contains(json, sv_from_cstr("\"calls\":1000,"))) {
+        fprintf(stderr, "[ERROR] unexpected report after the reset:\n"SV_PRINT_FORMAT"\n", SV_PRINT_ARGS(json));
+        return 1;
+    }
+    sb_free(&report);
+
+    printf("%d threads recorded calls during %d reports and resets, %ld profile tables were used\n",
+           ROUNDS * THREADS, ROUNDS * 10, tables);
+    return 0;
+}
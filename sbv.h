@@ -8,7 +8,9 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <limits.h>
 #include <string.h>
 #include <strings.h>
 #include <ctype.h>
@@ -32,10 +34,55 @@
 #define SBV_FREE free
 #endif // SBV_FREE
 
+#ifndef SB_CONCURRENT_SEGMENT_SIZE
+#define SB_CONCURRENT_SEGMENT_SIZE (1u * 1024 * 1024) // default segment size of sb_concurrent_t
+#endif // SB_CONCURRENT_SEGMENT_SIZE
+
 #ifndef SB_INIT_CAPACITY
 #define SB_INIT_CAPACITY 64
 #endif // SB_INIT_CAPACITY
 
+// define SBV_LARGE_BUFFERS to back string builders of at least SBV_MMAP_THRESHOLD bytes with mmap (Linux only)
+// these buffers grow with mremap, which remaps the pages instead of copying the content
+// mremap is a GNU extension, so define _GNU_SOURCE before including any header (e.g. compile with -D_GNU_SOURCE)
+// define SBV_HUGEPAGES in addition to advise the kernel to use transparent huge pages for them
+#ifndef SBV_MMAP_THRESHOLD
+#define SBV_MMAP_THRESHOLD (64u * 1024 * 1024)
+#endif // SBV_MMAP_THRESHOLD
+
+// define SBV_POOL to recycle string builder buffers through a thread-safe pool of power-of-two size classes
+// freed buffers go to a per-thread cache first and then to a lock-free shared freelist, each with a cap on retained memory
+#ifndef SBV_POOL_MAX_CAPACITY
+#define SBV_POOL_MAX_CAPACITY (1u * 1024 * 1024)    // largest buffer kept in the pool
+#endif // SBV_POOL_MAX_CAPACITY
+#ifndef SBV_POOL_THREAD_CACHE
+#define SBV_POOL_THREAD_CACHE 8                     // buffers per size class cached by each thread
+#endif // SBV_POOL_THREAD_CACHE
+#ifndef SBV_POOL_THREAD_RETAINED
+#define SBV_POOL_THREAD_RETAINED (4u * 1024 * 1024) // bytes cached by each thread
+#endif // SBV_POOL_THREAD_RETAINED
+#ifndef SBV_POOL_GLOBAL_SLOTS
+#define SBV_POOL_GLOBAL_SLOTS 32                    // buffers per size class in the shared freelist
+#endif // SBV_POOL_GLOBAL_SLOTS
+#ifndef SBV_POOL_GLOBAL_RETAINED
+#define SBV_POOL_GLOBAL_RETAINED (64u * 1024 * 1024) // bytes retained by the shared freelist
+#endif // SBV_POOL_GLOBAL_RETAINED
+
+// define SBV_THREADS to enable the features that start their own threads (POSIX threads, link with -pthread)
+// it also lets SBV_POOL and SBV_PROFILE hand on the cache and the table of a thread when the thread exits
+// define SBV_PROFILE to count, time and attribute every call of the public sv_*/ sb_* functions to its call site
+// the wrappers are macros, so sbv.h has to be included only once per translation unit
+#ifndef SBV_PROFILE_SITES
+#define SBV_PROFILE_SITES 512 // call sites recorded per thread, a power of two
+#endif // SBV_PROFILE_SITES
+
+#ifndef SV_READER_BLOCK_SIZE
+#define SV_READER_BLOCK_SIZE (1u * 1024 * 1024)
+#endif // SV_READER_BLOCK_SIZE
+#ifndef SV_READER_BLOCK_COUNT
+#define SV_READER_BLOCK_COUNT 4
+#endif // SV_READER_BLOCK_COUNT
+
 #ifdef _WIN32
 #define strncasecmp _strnicmp
 #endif // _WIN32
@@ -45,6 +92,12 @@
 #define SV_TRIM_ALL 0
 #define SV_PRINT_FORMAT "%.*s"
 #define SV_PRINT_ARGS(sv) (int)(sv).len, (sv).items
+#define SV_GLOB_CASE 1     // match case-insensitively
+#define SV_GLOB_PATHNAME 2 // `*`, `?` and classes do not match '/'
+#define SV_TRIE_CASE 1     // match case-insensitively, like sv_starts_with_case
+#define SV_SCHEMA_CASE 1   // match keys case-insensitively
+#define SB_BASE64_URL 1    // use the URL-safe alphabet, '-' and '_' instead of '+' and '/'
+#define SB_BASE64_NO_PAD 2 // omit the trailing '=' padding
 
 // convenience macros to iterate over substrings of a string view split by a delimiter
 // these macros repeatedly call sv_split*, yielding each left-hand substring in `it`
@@ -73,6 +126,39 @@
 #    define SBV_PRINTF_FORMAT(STRING_INDEX, FIRST_TO_CHECK)
 #endif
 
+// atomic operations for the thread-safe parts of the library
+#if defined(__GNUC__) || defined(__clang__)
+#    define SBV__HAS_ATOMICS
+#    define SBV__ATOMIC(T) T
+#    define SBV__THREAD_LOCAL __thread
+#    define SBV__ATOMIC_LOAD(p)          __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#    define SBV__ATOMIC_STORE(p, v)      __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#    define SBV__ATOMIC_EXCHANGE(p, v)   __atomic_exchange_n((p), (v), __ATOMIC_ACQ_REL)
+#    define SBV__ATOMIC_CAS(p, e, d)     __atomic_compare_exchange_n((p), (e), (d), false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#    define SBV__ATOMIC_FETCH_ADD(p, v)  __atomic_fetch_add((p), (v), __ATOMIC_ACQ_REL)
+#    define SBV__ATOMIC_FETCH_SUB(p, v)  __atomic_fetch_sub((p), (v), __ATOMIC_ACQ_REL)
+#    define SBV__ATOMIC_FENCE()          __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_ATOMICS__)
+#    include <stdatomic.h>
+#    define SBV__HAS_ATOMICS
+#    define SBV__ATOMIC(T) _Atomic(T)
+#    define SBV__THREAD_LOCAL _Thread_local
+#    define SBV__ATOMIC_LOAD(p)          atomic_load_explicit((p), memory_order_acquire)
+#    define SBV__ATOMIC_STORE(p, v)      atomic_store_explicit((p), (v), memory_order_release)
+#    define SBV__ATOMIC_EXCHANGE(p, v)   atomic_exchange_explicit((p), (v), memory_order_acq_rel)
+#    define SBV__ATOMIC_CAS(p, e, d)     atomic_compare_exchange_strong_explicit((p), (e), (d), memory_order_acq_rel, memory_order_acquire)
+#    define SBV__ATOMIC_FETCH_ADD(p, v)  atomic_fetch_add_explicit((p), (v), memory_order_acq_rel)
+#    define SBV__ATOMIC_FETCH_SUB(p, v)  atomic_fetch_sub_explicit((p), (v), memory_order_acq_rel)
+#    define SBV__ATOMIC_FENCE()          atomic_thread_fence(memory_order_seq_cst)
+#endif
+
+#if defined(SBV_POOL) && !defined(SBV__HAS_ATOMICS)
+#    error "SBV_POOL requires GCC/Clang atomic builtins or C11 atomics"
+#endif // SBV_POOL
+#if defined(SBV_PROFILE) && !defined(SBV__HAS_ATOMICS)
+#    error "SBV_PROFILE requires GCC/Clang atomic builtins or C11 atomics"
+#endif // SBV_PROFILE
+
 typedef struct {
     char *items;       // pointer to the buffer, (owned)
     size_t count;      // number of bytes used
@@ -84,6 +170,122 @@ typedef struct{
     size_t len;        // number of bytes
 } sv_t;
 
+// a glob pattern compiled into a bit-parallel NFA, matching in time linear in the length of the input
+typedef struct {
+    uint64_t *masks;   // `words` words per byte value, bit i+1 is set if the i-th element of the pattern matches the byte
+    uint64_t *loops;   // `words` words, bit i is set if there is a `*` after the i-th element of the pattern
+    size_t words;
+    size_t states;     // number of elements of the pattern consuming one byte
+    size_t start;      // state after matching `prefix`
+    bool has_star;
+    int flags;
+    char *literals;    // storage of the following views
+    sv_t prefix;       // literal bytes every match starts with
+    sv_t suffix;       // literal bytes every match ends with, only set if there is a `*`
+    sv_t required;     // longest literal run every match contains
+} sv_glob_t;
+
+// type of a template placeholder, selected by the letter after the colon in `{name:x}`
+typedef enum {
+    SB_TEMPLATE_SV,     // {name} or {name:v}, sv_t
+    SB_TEMPLATE_CSTR,   // {name:s}, const char*
+    SB_TEMPLATE_INT,    // {name:d}, int64_t
+    SB_TEMPLATE_UINT,   // {name:u}, uint64_t
+    SB_TEMPLATE_HEX,    // {name:x}, uint64_t in lower case hex
+    SB_TEMPLATE_CHAR,   // {name:c}, char
+    SB_TEMPLATE_DOUBLE, // {name:f}, double formatted like "%g"
+} sb_template_type_t;
+
+// value of a template argument, the member matching the type of the placeholder is used
+typedef union {
+    sv_t sv;
+    const char *cstr;
+    int64_t i;
+    uint64_t u;
+    char c;
+    double f;
+} sb_template_arg_t;
+
+typedef struct {
+    size_t offset;            // literal text preceding the placeholder
+    size_t len;
+    size_t arg;               // index of the argument, SIZE_MAX for the trailing literal
+} sb_template_part_t;
+
+// a format string compiled into literal runs and typed placeholders
+typedef struct {
+    char *literals;           // literal text, with `{{` and `}}` resolved
+    size_t literals_len;
+    sb_template_part_t *parts;
+    size_t parts_count;
+    sv_t *names;              // name of each argument, placeholders with the same name share an argument
+    sb_template_type_t *types;
+    size_t args_count;
+} sb_template_t;
+
+#ifdef SBV__HAS_ATOMICS
+// a view into a frozen, immutable buffer that keeps the buffer alive
+typedef struct {
+    const char *items;
+    size_t len;
+    struct sbv__shared *owner; // reference held by this view, NULL for views of nothing
+} sv_shared_t;
+#endif // SBV__HAS_ATOMICS
+
+#ifdef SBV__HAS_ATOMICS
+typedef struct sb_concurrent sb_concurrent_t;
+#endif // SBV__HAS_ATOMICS
+
+// offsets of the line starts in a text, lines are separated by '\n'
+typedef struct {
+    size_t *starts;           // offset of the first byte of every line, starts[0] is always 0
+    size_t count;             // number of lines, a text without newlines is a single line
+    size_t capacity;
+    size_t len;               // number of bytes indexed so far
+} sv_lines_t;
+
+// a set of prefixes compiled into a byte trie, stored breadth-first so that the children of a node are adjacent
+typedef struct {
+    uint32_t *children;       // children of node i are the nodes [children[i], children[i+1])
+    unsigned char *labels;    // byte on the edge into every node
+    size_t *prefixes;         // index of the prefix ending at every node, or SIZE_MAX
+    size_t nodes_count;
+    int flags;
+} sv_trie_t;
+
+// a string builder with a movable gap, for inserting and erasing at arbitrary offsets
+typedef struct {
+    char *items;       // text before the gap, the gap and the text after the gap (owned)
+    size_t gap_start;  // offset of the gap, which is also the length of the text before it
+    size_t gap_end;    // offset of the text after the gap
+    size_t capacity;   // total allocated capacity
+} sb_gap_t;
+
+// byte translation table for sv_translate and friends
+typedef struct {
+    int16_t map[256];         // replacement of every byte, or -1 to delete it
+} sv_translate_t;
+
+// a set of wanted keys for extracting values from `key=value` records
+typedef struct {
+    sv_trie_t keys;           // lookups give the slot of a key
+    size_t count;             // number of slots
+    char field_sep;           // separator between fields, e.g. ' ', ';' or '\n'
+    char pair_sep;            // separator between key and value, e.g. '=' or ':'
+} sv_schema_t;
+
+#ifdef SBV_THREADS
+typedef struct sv_reader sv_reader_t;
+
+typedef struct {
+    size_t block_size;       // bytes per read, rounded up to 4096 (0 for SV_READER_BLOCK_SIZE)
+    size_t block_count;      // blocks read ahead of the consumer (0 for SV_READER_BLOCK_COUNT)
+    bool direct;             // bypass the page cache with O_DIRECT, which needs _GNU_SOURCE defined before any header
+    bool split;              // only hand out chunks ending in `delimiter`, so records are never split across chunks
+    char delimiter;
+} sv_reader_opts_t;
+#endif // SBV_THREADS
+
 #ifdef __cplusplus
 extern "C" {
 #endif // __cplusplus
@@ -103,6 +305,13 @@ SBVDEF int sb_append_sv(sb_t *sb, sv_t sv);
 SBVDEF int sb_append_char(sb_t *sb, char c);
 SBVDEF int sb_append_null(sb_t *sb);
 SBVDEF int sb_append_file(sb_t *sb, const char *filename);
+// append multiple string views, reserving the total length once
+SBVDEF int sb_append_many(sb_t *sb, const sv_t *svs, size_t count);
+// append string views given as arguments, e.g. `sb_append_svs(&sb, a, sv_from_cstr(", "), b)`
+#define sb_append_svs(sb, ...) \
+    sb_append_many((sb), (const sv_t[]){__VA_ARGS__}, sizeof((const sv_t[]){__VA_ARGS__})/sizeof(sv_t))
+// append multiple string views, each wrapped in prefix and suffix, with sep between them
+SBVDEF int sb_join(sb_t *sb, const sv_t *svs, size_t count, sv_t sep, sv_t prefix, sv_t suffix);
 
 // pop the last n-bytes of the string builder
 // return the number of bytes popped on success, or a negative value on error
@@ -117,19 +326,57 @@ SBVDEF int sb_extract_slice(const sb_t *sb, size_t n, char *buff, size_t buff_si
 // return the allocated string
 SBVDEF char* sb_to_cstr(const sb_t *sb);
 
+// size-safe variants of the functions above for content larger than INT_MAX bytes, the int variants fail instead
+// return the number of bytes on success, or a negative value on error
+SBVDEF ptrdiff_t sb_append_cstr_z(sb_t *sb, const char *cstr);
+SBVDEF ptrdiff_t sb_append_slice_z(sb_t *sb, const char *buff, size_t n);
+SBVDEF ptrdiff_t sb_append_sv_z(sb_t *sb, sv_t sv);
+SBVDEF ptrdiff_t sb_append_file_z(sb_t *sb, const char *filename);
+SBVDEF ptrdiff_t sb_pop_z(sb_t *sb, size_t n);
+SBVDEF ptrdiff_t sb_extract_z(const sb_t *sb, char *buff, size_t buff_size);
+SBVDEF ptrdiff_t sb_extract_slice_z(const sb_t *sb, size_t n, char *buff, size_t buff_size);
+
 // null terminate the string builder's content and hand off owning of the content
-// return the string builder's content
+// return the string builder's content, which has to be freed with SBV_FREE
 SBVDEF char* sb_detach(sb_t *sb);
 
 // reserve space for additional bytes
 // return success
 SBVDEF bool sb_reserve(sb_t *sb, size_t bytes);
+// release unused capacity, keeping room for a null-terminator, an empty string builder is freed entirely
+// return success
+SBVDEF bool sb_shrink_to_fit(sb_t *sb);
 
 // reset the string builder
 SBVDEF void sb_clear(sb_t *sb);
 // reset string builder and free allocated memory
+// with SBV_POOL the buffer is returned to the buffer pool instead
 SBVDEF void sb_free(sb_t *sb);
 
+#ifdef SBV_POOL
+// create an empty string builder with room for at least `capacity` bytes, reusing a pooled buffer if available
+SBVDEF sb_t sb_pool_acquire(size_t capacity);
+// move the buffers cached by the calling thread into the shared pool
+// with SBV_THREADS this happens on thread exit, otherwise call it before a thread exits or its cache leaks
+SBVDEF void sb_pool_flush_thread(void);
+// free the buffers cached by the calling thread and all buffers in the shared pool
+SBVDEF void sb_pool_trim(void);
+#endif // SBV_POOL
+
+#ifdef SBV__HAS_ATOMICS
+// hand off the string builder's buffer, without copying it, to an immutable reference-counted buffer
+// return a shared view of the whole content, or a view with NULL items on error (the string builder is unchanged then)
+SBVDEF sv_shared_t sb_freeze(sb_t *sb);
+// take another reference to the buffer of a shared view, safe to call from any thread
+SBVDEF sv_shared_t sv_shared_retain(sv_shared_t shared);
+// take a reference to a subrange of a shared view, clamped to the view
+SBVDEF sv_shared_t sv_shared_slice(sv_shared_t shared, size_t start, size_t len);
+// drop the reference of a shared view, the buffer is freed when its last view is released
+SBVDEF void sv_shared_release(sv_shared_t *shared);
+// create a plain string view of a shared view, valid as long as the shared view is not released
+SBVDEF sv_t sv_from_shared(sv_shared_t shared);
+#endif // SBV__HAS_ATOMICS
+
 /* String View Functions */
 
 // create a string view
@@ -226,6 +473,8 @@ SBVDEF size_t sv_replace_len(sv_t sv, sv_t query, sv_t replace);
 // write a string view's content as a null-terminated string into a buffer
 // return the amount of bytes written (including the null-terminator), or a negative value on error
 SBVDEF int sv_extract(sv_t sv, char *buff, size_t buff_size);
+// size-safe variant for views longer than INT_MAX bytes, the int variant fails instead
+SBVDEF ptrdiff_t sv_extract_z(sv_t sv, char *buff, size_t buff_size);
 
 // return the size of a buffer that could hold a null-terminated copy of the string view's content
 SBVDEF size_t sv_cstr_size(sv_t sv);
@@ -234,6 +483,247 @@ SBVDEF size_t sv_cstr_size(sv_t sv);
 // return the allocated string
 SBVDEF char* sv_to_cstr(sv_t sv);
 
+#ifdef SBV_THREADS
+/* Read-Ahead Functions */
+
+// open a file and start reading it ahead on a background thread, `opts` may be NULL
+// with `direct`, files on a file system without O_DIRECT support are read through the page cache
+// return the reader, or NULL on error (also if `direct` is requested but O_DIRECT is not available)
+SBVDEF sv_reader_t* sv_reader_open(const char *filename, const sv_reader_opts_t *opts);
+// wait for the next chunk of the file, which stays valid until the next call
+// return the chunk, or sv_null at the end of the file or on error
+SBVDEF sv_t sv_reader_next(sv_reader_t *reader);
+// check whether reading the file failed
+SBVDEF bool sv_reader_failed(const sv_reader_t *reader);
+// stop the background thread, close the file and free the reader
+SBVDEF void sv_reader_close(sv_reader_t *reader);
+#endif // SBV_THREADS
+
+/* Glob Functions */
+
+// compile a glob pattern, flags are a combination of SV_GLOB_CASE and SV_GLOB_PATHNAME
+// `*` matches any sequence of bytes, `?` matches any byte, `[abc]`, `[a-z]` and `[!abc]` (or `[^abc]`) match a set of bytes
+// and `\` escapes the next byte
+// return success
+SBVDEF bool sv_glob_compile(sv_glob_t *glob, sv_t pattern, int flags);
+// check whether a string view matches a compiled glob pattern as a whole
+SBVDEF bool sv_glob_match(const sv_glob_t *glob, sv_t sv);
+// match a string view against many compiled glob patterns, storing the results in `matches` (if not NULL)
+// return the number of matching patterns
+SBVDEF size_t sv_glob_match_many(const sv_glob_t *globs, size_t count, sv_t sv, bool *matches);
+// free a compiled glob pattern
+SBVDEF void sv_glob_free(sv_glob_t *glob);
+
+/* Fuzzy Matching Functions */
+
+// compute the Levenshtein distance (insertions, deletions and substitutions) between two string views
+SBVDEF size_t sv_edit_distance(sv_t a, sv_t b);
+// compute the Levenshtein distance, giving up as soon as it is known to exceed max_distance
+// return the distance, or SIZE_MAX if it exceeds max_distance
+SBVDEF size_t sv_edit_distance_bounded(sv_t a, sv_t b, size_t max_distance);
+// find a query within a string view, allowing up to max_distance edits
+// return the index of the first match, or SIZE_MAX if not found, and store the length of the match in match_len (if not NULL)
+SBVDEF size_t sv_find_approx(sv_t sv, sv_t query, size_t max_distance, size_t *match_len);
+
+/* Sorting Functions */
+
+// sort string views into the order of sv_compare/ sv_compare_case, null views first
+SBVDEF void sv_sort(sv_t *svs, size_t count);
+SBVDEF void sv_sort_case(sv_t *svs, size_t count);
+#ifdef SBV_THREADS
+// same as sv_sort/ sv_sort_case, but using up to `threads` threads for large arrays
+SBVDEF void sv_sort_parallel(sv_t *svs, size_t count, size_t threads);
+SBVDEF void sv_sort_case_parallel(sv_t *svs, size_t count, size_t threads);
+#endif // SBV_THREADS
+// remove adjacent duplicates from a sorted array of string views, keeping the first of each run
+// return the new number of string views
+SBVDEF size_t sv_dedup(sv_t *svs, size_t count);
+SBVDEF size_t sv_dedup_case(sv_t *svs, size_t count);
+
+/* Escaping Functions */
+
+// append a string view's content escaped for use inside a JSON string (without the surrounding quotes)
+// append a string view's content percent-encoded, only unreserved characters (RFC 3986) are kept as-is
+// append a string view's content escaped for use inside a C string literal (without the surrounding quotes)
+// append a string view's content quoted as a single POSIX shell word: wrapped in '...', with every ' written as '\''
+// return the number of bytes appended on success, or a negative value on error
+SBVDEF int sb_append_json_escaped(sb_t *sb, sv_t sv);
+SBVDEF int sb_append_url_encoded(sb_t *sb, sv_t sv);
+SBVDEF int sb_append_c_escaped(sb_t *sb, sv_t sv);
+SBVDEF int sb_append_shell_escaped(sb_t *sb, sv_t sv);
+
+// append the decoded content of a percent-encoded string view ('+' is not treated as a space)
+// append the decoded content of a string view containing C escape sequences
+// return the number of bytes appended on success, or a negative value on error
+// on malformed input nothing is appended and the offset of the first invalid byte is stored in error_offset (if not NULL)
+SBVDEF int sb_append_url_decoded(sb_t *sb, sv_t sv, size_t *error_offset);
+SBVDEF int sb_append_c_unescaped(sb_t *sb, sv_t sv, size_t *error_offset);
+
+// append a string view's content base64-encoded, flags are a combination of SB_BASE64_URL and SB_BASE64_NO_PAD
+// append a string view's content hex-encoded with lower case digits
+// return the number of bytes appended on success, or a negative value on error
+SBVDEF int sb_append_base64_encoded(sb_t *sb, sv_t sv, int flags);
+SBVDEF int sb_append_hex_encoded(sb_t *sb, sv_t sv);
+
+// append the decoded content of a base64 string view, padding is required, with SB_BASE64_NO_PAD it is rejected instead
+// append the decoded content of a hex string view, upper and lower case digits are accepted
+// return the number of bytes appended on success, or a negative value on error
+// on malformed input nothing is appended and the offset of the first invalid byte (or the length for truncated input) is stored in error_offset (if not NULL)
+SBVDEF int sb_append_base64_decoded(sb_t *sb, sv_t sv, int flags, size_t *error_offset);
+SBVDEF int sb_append_hex_decoded(sb_t *sb, sv_t sv, size_t *error_offset);
+
+/* Template Functions */
+
+// compile a format string with `{name}` or `{name:type}` placeholders (`{}` is an unnamed one), `{{` and `}}` are literal braces
+// return success, on error the offset of the invalid placeholder is stored in error_offset (if not NULL)
+SBVDEF bool sb_template_compile(sb_template_t *tpl, sv_t format, size_t *error_offset);
+// return the index of a named argument, or SIZE_MAX if the template has no such placeholder
+SBVDEF size_t sb_template_arg_index(const sb_template_t *tpl, sv_t name);
+// render a template with `count` arguments (in the order their names first appear) into the string builder
+// return the number of bytes appended on success, or a negative value on error
+SBVDEF int sb_template_render(sb_t *sb, const sb_template_t *tpl, const sb_template_arg_t *args, size_t count);
+// free a compiled template
+SBVDEF void sb_template_free(sb_template_t *tpl);
+
+/* Line Index Functions */
+
+// index the line starts of a text, replacing any previous contents of the index
+// return success
+SBVDEF bool sv_lines_build(sv_lines_t *lines, sv_t sv);
+// index the bytes appended to a text since the last build or extend, e.g. `sv_lines_extend(&lines, sv_from_sb(&sb))`
+// the already indexed prefix has to be unchanged, but may have moved in memory
+// return success
+SBVDEF bool sv_lines_extend(sv_lines_t *lines, sv_t sv);
+// find the line (0-based) containing a byte offset, offsets up to the indexed length are valid
+// return the line and store the byte column in column (if not NULL), or SIZE_MAX if the offset is out of range
+SBVDEF size_t sv_lines_locate(const sv_lines_t *lines, size_t offset, size_t *column);
+// return the contents of a line (0-based) without its newline, or sv_null if the line is out of range
+SBVDEF sv_t sv_lines_get(const sv_lines_t *lines, sv_t sv, size_t line);
+// free the line index
+SBVDEF void sv_lines_free(sv_lines_t *lines);
+
+/* Prefix Trie Functions */
+
+// compile a set of prefixes into a trie, flags can be SV_TRIE_CASE
+// lookups return indices into the prefixes array, of duplicate prefixes the first one is used
+// return success
+SBVDEF bool sv_trie_build(sv_trie_t *trie, const sv_t *prefixes, size_t count, int flags);
+// find the longest prefix of a string view
+// return its index, or SIZE_MAX if no prefix matches
+SBVDEF size_t sv_trie_longest(const sv_trie_t *trie, sv_t sv);
+// find all prefixes of a string view, from shortest to longest, storing up to max indices in indices
+// return the number of matching prefixes, which may be more than max
+SBVDEF size_t sv_trie_all(const sv_trie_t *trie, sv_t sv, size_t *indices, size_t max);
+// find a prefix equal to a string view
+// return its index, or SIZE_MAX if not found
+SBVDEF size_t sv_trie_exact(const sv_trie_t *trie, sv_t sv);
+// free a compiled trie
+SBVDEF void sv_trie_free(sv_trie_t *trie);
+
+/* Transform Functions */
+
+// convert the ASCII letters of the string builder's content to lower or upper case in place
+SBVDEF void sb_to_lower(sb_t *sb);
+SBVDEF void sb_to_upper(sb_t *sb);
+// write a string view with its ASCII letters converted to lower or upper case into a buffer
+// return the resulting string view, truncated if necessary, always null-terminated if buff_size > 0
+SBVDEF sv_t sv_to_lower(sv_t sv, char *buff, size_t buff_size);
+SBVDEF sv_t sv_to_upper(sv_t sv, char *buff, size_t buff_size);
+// append a string view with its ASCII letters converted to lower or upper case
+// return the number of bytes appended on success, or a negative value on error
+SBVDEF int sb_append_lower(sb_t *sb, sv_t sv);
+SBVDEF int sb_append_upper(sb_t *sb, sv_t sv);
+
+// build a translation table like `tr`: the i-th byte of from is replaced by the i-th byte of to
+// (or by the last byte of to if it is shorter), and the bytes in del are deleted
+// an empty to deletes the bytes of from, like `tr -d`
+SBVDEF void sv_translate_init(sv_translate_t *tr, sv_t from, sv_t to, sv_t del);
+// translate the string builder's content in place
+SBVDEF void sb_translate(sb_t *sb, const sv_translate_t *tr);
+// write a translated string view into a buffer
+// return the resulting string view, truncated if necessary, always null-terminated if buff_size > 0
+SBVDEF sv_t sv_translate(sv_t sv, const sv_translate_t *tr, char *buff, size_t buff_size);
+// append a translated string view
+// return the number of bytes appended on success, or a negative value on error
+SBVDEF int sb_append_translated(sb_t *sb, sv_t sv, const sv_translate_t *tr);
+
+/* Gap Buffer Functions */
+
+// turn a string builder into a gap buffer with the gap at the end, without copying
+SBVDEF sb_gap_t sb_gap_from_sb(sb_t *sb);
+// return the length of the gap buffer's content
+SBVDEF size_t sb_gap_len(const sb_gap_t *gap);
+
+// insert a string view at an offset, moving the gap there
+// return the number of bytes inserted on success, or a negative value on error
+SBVDEF int sb_gap_insert(sb_gap_t *gap, size_t offset, sv_t sv);
+// erase up to n bytes at an offset, moving the gap there
+// return the number of bytes erased on success, or a negative value on error
+SBVDEF int sb_gap_erase(sb_gap_t *gap, size_t offset, size_t n);
+// replace up to n bytes at an offset with a string view
+// return the number of bytes inserted on success, or a negative value on error
+SBVDEF int sb_gap_replace(sb_gap_t *gap, size_t offset, size_t n, sv_t sv);
+
+// get the content as the text before and after the gap, empty segments are skipped so first is filled before second
+// return the number of non-empty segments
+SBVDEF size_t sb_gap_segments(const sb_gap_t *gap, sv_t *first, sv_t *second);
+// close the gap and hand the content off to a string builder, the gap buffer is reset
+SBVDEF sb_t sb_gap_compact(sb_gap_t *gap);
+// reset the gap buffer and free allocated memory
+SBVDEF void sb_gap_free(sb_gap_t *gap);
+
+#ifdef SBV__HAS_ATOMICS
+/* Concurrent Builder Functions */
+
+// create a builder that many threads can append to at once, segment_size is the size of its buffers (0 for SB_CONCURRENT_SEGMENT_SIZE)
+// return the builder, or NULL on error
+SBVDEF sb_concurrent_t* sb_concurrent_create(size_t segment_size);
+// append data without locking, safe to call from any number of threads
+// every call is appended as one contiguous record, which is never split between drained chunks
+// return the number of bytes appended on success, or a negative value on error
+SBVDEF int sb_concurrent_append(sb_concurrent_t *sb, sv_t sv);
+SBVDEF int sb_concurrent_appendf(sb_concurrent_t *sb, const char *fmt, ...) SBV_PRINTF_FORMAT(2, 3);
+SBVDEF int sb_concurrent_vappendf(sb_concurrent_t *sb, const char *fmt, va_list args);
+// take the next chunk of completely written records, in the order their space was reserved
+// only one thread may drain, and the chunk stays valid until its next call
+// return the chunk, or sv_null if nothing is ready
+SBVDEF sv_t sb_concurrent_drain(sb_concurrent_t *sb);
+// free the builder, no thread may be appending anymore
+SBVDEF void sb_concurrent_free(sb_concurrent_t *sb);
+#endif // SBV__HAS_ATOMICS
+
+/* Field Extraction Functions */
+
+// compile the keys of a schema, the value of keys[i] is stored in slot i, flags can be SV_SCHEMA_CASE
+// return success
+SBVDEF bool sv_schema_compile(sv_schema_t *schema, const sv_t *keys, size_t count, char field_sep, char pair_sep, int flags);
+// extract the values of the schema's keys from a record into values (one slot per key) without copying
+// keys and values are trimmed of whitespace, values in double quotes are stored without them and may contain separators
+// (backslash escapes are skipped, not resolved), fields without a pair separator and unknown keys are skipped
+// missing keys are stored as sv_null, and of repeated keys the first value is used
+// return the number of keys found
+SBVDEF size_t sv_schema_extract(const sv_schema_t *schema, sv_t record, sv_t *values);
+// free a compiled schema
+SBVDEF void sv_schema_free(sv_schema_t *schema);
+
+#ifdef SBV_PROFILE
+/* Profiling Functions */
+
+// write the calls recorded so far, merged over all threads and sorted by total time, as a text table or as JSON
+// the reports and the reset may run while other threads record calls, a call recorded meanwhile may be missed
+SBVDEF void sbv_profile_report(FILE *f);
+SBVDEF void sbv_profile_report_json(FILE *f);
+// forget the calls recorded so far
+SBVDEF void sbv_profile_reset(void);
+// hand the calling thread's table to the next thread that records a call, its calls stay in the reports
+// with SBV_THREADS this happens on thread exit, otherwise call it before a thread exits or its table stays unused
+SBVDEF void sbv_profile_release_thread(void);
+// record a call manually, e.g. to profile your own functions
+SBVDEF void sbv_profile_record(const char *function, const char *file, int line, size_t bytes, uint64_t ticks);
+// read the time stamp counter (or a monotonic clock where there is none)
+SBVDEF uint64_t sbv_profile_ticks(void);
+#endif // SBV_PROFILE
+
 /* Helper Functions */
 
 // case-insensitive libc `memcmp`
@@ -249,6 +739,319 @@ SBVDEF char* sbv_strdup(const char *string);
 
 #ifdef SBV_IMPLEMENTATION
 
+// word-at-a-time (SWAR) byte tests, each macro is non-zero if any byte of the 64-bit word matches
+#define SBV__ONES  0x0101010101010101ull
+#define SBV__HIGHS 0x8080808080808080ull
+#define SBV__HAS_ZERO(v)    (((v) - SBV__ONES) & ~(v) & SBV__HIGHS)
+#define SBV__HAS_BYTE(v, c) SBV__HAS_ZERO((v) ^ (SBV__ONES * (uint8_t)(c)))
+#define SBV__HAS_LESS(v, n) (((v) - SBV__ONES * (n)) & ~(v) & SBV__HIGHS) // n <= 128
+
+static inline uint64_t sbv__load64(const char *p)
+{
+    uint64_t v;
+    (void) memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// convert the ASCII upper case letters of a word to lower case
+static inline uint64_t sbv__swar_lower(uint64_t v)
+{
+    uint64_t ascii = v & ~SBV__HIGHS;
+    uint64_t ge_a = ascii + SBV__ONES * (0x80 - 'A');
+    uint64_t gt_z = ascii + SBV__ONES * (0x80 - 'Z' - 1);
+    uint64_t upper = (ge_a ^ gt_z) & ~v & SBV__HIGHS;
+    return v | (upper >> 2);
+}
+
+// convert the ASCII lower case letters of a word to upper case
+static inline uint64_t sbv__swar_upper(uint64_t v)
+{
+    uint64_t ascii = v & ~SBV__HIGHS;
+    uint64_t ge_a = ascii + SBV__ONES * (0x80 - 'a');
+    uint64_t gt_z = ascii + SBV__ONES * (0x80 - 'z' - 1);
+    uint64_t lower = (ge_a ^ gt_z) & ~v & SBV__HIGHS;
+    return v & ~(lower >> 2);
+}
+
+static inline int sbv__hex_value(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static const char sbv__hex_digits[] = "0123456789ABCDEF";
+
+#if defined(SBV_LARGE_BUFFERS) && defined(__linux__)
+#define SBV__MMAP
+#include <sys/mman.h>
+#include <unistd.h>
+#if !defined(MAP_ANONYMOUS) || !defined(MREMAP_MAYMOVE)
+#error "SBV_LARGE_BUFFERS needs MAP_ANONYMOUS and mremap(), define _GNU_SOURCE before including any header"
+#endif // MAP_ANONYMOUS || MREMAP_MAYMOVE
+#endif // SBV_LARGE_BUFFERS
+
+// every buffer with a capacity of at least SBV_MMAP_THRESHOLD is mapped, every smaller one comes from SBV_MALLOC
+#ifdef SBV__MMAP
+static inline bool sbv__buffer_mapped(size_t capacity)
+{
+    return capacity >= SBV_MMAP_THRESHOLD;
+}
+
+static inline size_t sbv__page_round(size_t capacity)
+{
+    size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    if (capacity > SIZE_MAX - (page - 1)) return SIZE_MAX;
+    return (capacity + page - 1) / page * page;
+}
+
+static inline void sbv__buffer_advise(void *items, size_t capacity)
+{
+#if defined(SBV_HUGEPAGES) && defined(MADV_HUGEPAGE)
+    (void) madvise(items, capacity, MADV_HUGEPAGE);
+#else
+    (void) items;
+    (void) capacity;
+#endif // SBV_HUGEPAGES
+}
+
+static inline char* sbv__buffer_map(size_t capacity)
+{
+    void *items = mmap(NULL, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (items == MAP_FAILED) return NULL;
+    sbv__buffer_advise(items, capacity);
+    return items;
+}
+#endif // SBV__MMAP
+
+#ifdef SBV_POOL
+#define SBV__POOL_CLASSES 64 // one size class per power of two
+
+// the shared freelist is a fixed array of slots per size class
+// a buffer is pushed by a CAS of an empty slot and popped by exchanging a slot with NULL, which can not suffer from ABA
+static SBV__ATOMIC(char*) sbv__pool_slots[SBV__POOL_CLASSES][SBV_POOL_GLOBAL_SLOTS];
+static SBV__ATOMIC(size_t) sbv__pool_retained;
+
+typedef struct {
+    char *items[SBV__POOL_CLASSES][SBV_POOL_THREAD_CACHE];
+    size_t count[SBV__POOL_CLASSES];
+    size_t retained;
+    bool registered;   // the thread-exit destructor is set up for this cache
+} sbv__pool_cache_t;
+
+static SBV__THREAD_LOCAL sbv__pool_cache_t sbv__pool_cache;
+
+static inline void sbv__pool_flush(sbv__pool_cache_t *cache);
+
+#ifdef SBV_THREADS
+#include <pthread.h>
+
+// with SBV_THREADS a thread's cache is flushed when the thread exits
+static pthread_key_t sbv__pool_key;
+static pthread_once_t sbv__pool_key_once = PTHREAD_ONCE_INIT;
+
+static inline void sbv__pool_exit(void *cache)
+{
+    ((sbv__pool_cache_t*) cache)->registered = false;
+    sbv__pool_flush(cache);
+}
+
+static inline void sbv__pool_key_create(void)
+{
+    (void) pthread_key_create(&sbv__pool_key, sbv__pool_exit);
+}
+
+static inline void sbv__pool_register(sbv__pool_cache_t *cache)
+{
+    (void) pthread_once(&sbv__pool_key_once, sbv__pool_key_create);
+    cache->registered = pthread_setspecific(sbv__pool_key, cache) == 0;
+}
+#else
+static inline void sbv__pool_register(sbv__pool_cache_t *cache)
+{
+    (void) cache;
+}
+#endif // SBV_THREADS
+
+static inline size_t sbv__log2_floor(size_t n)
+{
+    size_t log = 0;
+    while (n >>= 1) log += 1;
+    return log;
+}
+
+static inline bool sbv__pool_poolable(size_t capacity)
+{
+    return capacity >= SB_INIT_CAPACITY && capacity <= SBV_POOL_MAX_CAPACITY;
+}
+
+// round a capacity up to its size class
+static inline size_t sbv__pool_class_capacity(size_t capacity)
+{
+    size_t class_capacity = (size_t)1 << sbv__log2_floor(capacity);
+    return class_capacity == capacity ? capacity : class_capacity << 1;
+}
+
+static inline bool sbv__pool_push_global(size_t size_class, char *items)
+{
+    size_t size = (size_t)1 << size_class;
+    if (SBV__ATOMIC_FETCH_ADD(&sbv__pool_retained, size) + size > SBV_POOL_GLOBAL_RETAINED){
+        SBV__ATOMIC_FETCH_SUB(&sbv__pool_retained, size);
+        return false;
+    }
+    for (size_t i=0; i<SBV_POOL_GLOBAL_SLOTS; ++i){
+        char *expected = NULL;
+        if (SBV__ATOMIC_LOAD(&sbv__pool_slots[size_class][i]) == NULL &&
+            SBV__ATOMIC_CAS(&sbv__pool_slots[size_class][i], &expected, items)) return true;
+    }
+    SBV__ATOMIC_FETCH_SUB(&sbv__pool_retained, size);
+    return false;
+}
+
+static inline char* sbv__pool_pop_global(size_t size_class)
+{
+    for (size_t i=0; i<SBV_POOL_GLOBAL_SLOTS; ++i){
+        if (SBV__ATOMIC_LOAD(&sbv__pool_slots[size_class][i]) == NULL) continue;
+        char *items = SBV__ATOMIC_EXCHANGE(&sbv__pool_slots[size_class][i], (char*) NULL);
+        if (items != NULL){
+            SBV__ATOMIC_FETCH_SUB(&sbv__pool_retained, (size_t)1 << size_class);
+            return items;
+        }
+    }
+    return NULL;
+}
+
+// take a buffer of exactly `capacity` bytes (a size class) from the pool
+// return the buffer, or NULL if the pool has none
+static inline char* sbv__pool_acquire(size_t capacity)
+{
+    if (!sbv__pool_poolable(capacity)) return NULL;
+    size_t size_class = sbv__log2_floor(capacity);
+
+    sbv__pool_cache_t *cache = &sbv__pool_cache;
+    if (cache->count[size_class] > 0){
+        cache->retained -= capacity;
+        return cache->items[size_class][--cache->count[size_class]];
+    }
+    return sbv__pool_pop_global(size_class);
+}
+
+// hand a buffer to the pool
+// return false if the pool does not take it, in which case the caller has to free it
+static inline bool sbv__pool_release(char *items, size_t capacity)
+{
+    if (items == NULL || !sbv__pool_poolable(capacity)) return false;
+    size_t size_class = sbv__log2_floor(capacity);
+    size_t size = (size_t)1 << size_class;
+
+    sbv__pool_cache_t *cache = &sbv__pool_cache;
+    if (cache->count[size_class] < SBV_POOL_THREAD_CACHE && cache->retained + size <= SBV_POOL_THREAD_RETAINED){
+        if (!cache->registered) sbv__pool_register(cache);
+        cache->items[size_class][cache->count[size_class]++] = items;
+        cache->retained += size;
+        return true;
+    }
+    return sbv__pool_push_global(size_class, items);
+}
+
+static inline void sbv__pool_flush(sbv__pool_cache_t *cache)
+{
+    for (size_t size_class=0; size_class<SBV__POOL_CLASSES; ++size_class){
+        while (cache->count[size_class] > 0){
+            char *items = cache->items[size_class][--cache->count[size_class]];
+            if (!sbv__pool_push_global(size_class, items)) SBV_FREE(items);
+        }
+    }
+    cache->retained = 0;
+}
+
+SBVDEF void sb_pool_flush_thread(void)
+{
+    sbv__pool_flush(&sbv__pool_cache);
+}
+
+SBVDEF void sb_pool_trim(void)
+{
+    sbv__pool_cache_t *cache = &sbv__pool_cache;
+    for (size_t size_class=0; size_class<SBV__POOL_CLASSES; ++size_class){
+        while (cache->count[size_class] > 0){
+            SBV_FREE(cache->items[size_class][--cache->count[size_class]]);
+        }
+        char *items;
+        while ((items = sbv__pool_pop_global(size_class)) != NULL){
+            SBV_FREE(items);
+        }
+    }
+    cache->retained = 0;
+}
+#endif // SBV_POOL
+
+// round a capacity computed by the growth policy to what the backing allocator hands out
+static inline size_t sbv__buffer_capacity(size_t capacity)
+{
+#ifdef SBV__MMAP
+    if (sbv__buffer_mapped(capacity)) return sbv__page_round(capacity);
+#endif // SBV__MMAP
+#ifdef SBV_POOL
+    if (capacity <= SBV_POOL_MAX_CAPACITY) return sbv__pool_class_capacity(capacity);
+#endif // SBV_POOL
+    return capacity;
+}
+
+// move a buffer holding `count` bytes of content to a new capacity
+// return the new buffer, or NULL on error in which case the old buffer stays valid
+static inline char* sbv__buffer_resize(char *items, size_t capacity, size_t count, size_t new_capacity)
+{
+#ifdef SBV_POOL
+    if (new_capacity > capacity){
+        char *pooled = sbv__pool_acquire(new_capacity);
+        if (pooled != NULL){
+            if (count > 0) (void) memcpy(pooled, items, count);
+            if (items != NULL && !sbv__pool_release(items, capacity)) SBV_FREE(items);
+            return pooled;
+        }
+    }
+#endif // SBV_POOL
+#ifdef SBV__MMAP
+    bool mapped = sbv__buffer_mapped(capacity);
+    bool new_mapped = sbv__buffer_mapped(new_capacity);
+    if (mapped && new_mapped){
+        void *new_items = mremap(items, capacity, new_capacity, MREMAP_MAYMOVE);
+        if (new_items == MAP_FAILED) return NULL;
+        sbv__buffer_advise(new_items, new_capacity);
+        return new_items;
+    }
+    if (mapped || new_mapped){
+        char *new_items = new_mapped ? sbv__buffer_map(new_capacity) : SBV_MALLOC(new_capacity);
+        if (new_items == NULL) return NULL;
+        if (count > 0) (void) memcpy(new_items, items, SBV_MIN(count, new_capacity));
+        if (mapped) (void) munmap(items, capacity);
+        else SBV_FREE(items);
+        return new_items;
+    }
+#else
+    (void) capacity;
+    (void) count;
+#endif // SBV__MMAP
+    return SBV_REALLOC(items, new_capacity);
+}
+
+static inline void sbv__buffer_free(char *items, size_t capacity)
+{
+#ifdef SBV__MMAP
+    if (items != NULL && sbv__buffer_mapped(capacity)){
+        (void) munmap(items, capacity);
+        return;
+    }
+#endif // SBV__MMAP
+#ifdef SBV_POOL
+    if (sbv__pool_release(items, capacity)) return;
+#endif // SBV_POOL
+    (void) capacity;
+    SBV_FREE(items);
+}
+
 SBVDEF int sbv_memicmp(const void *a, const void *b, size_t n)
 {
     const unsigned char *pa = (const unsigned char *)a;
@@ -305,7 +1108,8 @@ SBVDEF bool sb_reserve(sb_t *sb, size_t bytes)
         }
     }
     if (capacity != sb->capacity){
-        char *new_items = SBV_REALLOC(sb->items, sizeof(*sb->items) * capacity);
+        capacity = sbv__buffer_capacity(capacity);
+        char *new_items = sbv__buffer_resize(sb->items, sb->capacity, sb->count, capacity);
         if (new_items == NULL) return false;
 
         sb->items = new_items;
@@ -353,15 +1157,92 @@ SBVDEF int sb_append_sv(sb_t *sb, sv_t sv)
 }
 
 SBVDEF int sb_append_slice(sb_t *sb, const char *buff, size_t n)
+{
+    if (n > INT_MAX) return -1;
+    return (int) sb_append_slice_z(sb, buff, n);
+}
+
+SBVDEF ptrdiff_t sb_append_sv_z(sb_t *sb, sv_t sv)
+{
+    return sb_append_slice_z(sb, sv.items, sv.len);
+}
+
+SBVDEF ptrdiff_t sb_append_slice_z(sb_t *sb, const char *buff, size_t n)
 {
     if (sb == NULL || buff == NULL) return -1;
+    if (n > (size_t) PTRDIFF_MAX) return -1;
 
     if (!sb_reserve(sb, n)) return -1;
 
     (void) memcpy(&sb->items[sb->count], buff, n);
 
     sb->count += n;
-    return n;
+    return (ptrdiff_t) n;
+}
+
+SBVDEF int sb_append_many(sb_t *sb, const sv_t *svs, size_t count)
+{
+    if (sb == NULL || (svs == NULL && count > 0)) return -1;
+
+    size_t total = 0;
+    for (size_t i=0; i<count; ++i){
+        if (svs[i].items == NULL && svs[i].len > 0) return -1;
+        if (svs[i].len > SIZE_MAX - total) return -1;
+        total += svs[i].len;
+    }
+    if (total > INT_MAX || !sb_reserve(sb, total)) return -1;
+
+    char *out = &sb->items[sb->count];
+    for (size_t i=0; i<count; ++i){
+        if (svs[i].len == 0) continue;
+        (void) memcpy(out, svs[i].items, svs[i].len);
+        out += svs[i].len;
+    }
+
+    sb->count += total;
+    return total;
+}
+
+SBVDEF int sb_join(sb_t *sb, const sv_t *svs, size_t count, sv_t sep, sv_t prefix, sv_t suffix)
+{
+    if (sb == NULL || (svs == NULL && count > 0)) return -1;
+    if ((sep.items == NULL && sep.len > 0) || (prefix.items == NULL && prefix.len > 0) ||
+        (suffix.items == NULL && suffix.len > 0)) return -1;
+    if (count == 0) return 0;
+
+    size_t per_item = prefix.len + suffix.len;
+    if (per_item < prefix.len || sep.len > SIZE_MAX - per_item) return -1;
+    if (per_item + sep.len > (SIZE_MAX - per_item) / count) return -1;
+    size_t total = (count - 1) * (per_item + sep.len) + per_item;
+    for (size_t i=0; i<count; ++i){
+        if (svs[i].items == NULL && svs[i].len > 0) return -1;
+        if (svs[i].len > SIZE_MAX - total) return -1;
+        total += svs[i].len;
+    }
+    if (total > INT_MAX || !sb_reserve(sb, total)) return -1;
+
+    char *out = &sb->items[sb->count];
+    for (size_t i=0; i<count; ++i){
+        if (i > 0 && sep.len > 0){
+            (void) memcpy(out, sep.items, sep.len);
+            out += sep.len;
+        }
+        if (prefix.len > 0){
+            (void) memcpy(out, prefix.items, prefix.len);
+            out += prefix.len;
+        }
+        if (svs[i].len > 0){
+            (void) memcpy(out, svs[i].items, svs[i].len);
+            out += svs[i].len;
+        }
+        if (suffix.len > 0){
+            (void) memcpy(out, suffix.items, suffix.len);
+            out += suffix.len;
+        }
+    }
+
+    sb->count += total;
+    return total;
 }
 
 SBVDEF int sb_append_cstr(sb_t *sb, const char *cstr)
@@ -370,6 +1251,12 @@ SBVDEF int sb_append_cstr(sb_t *sb, const char *cstr)
     return sb_append_slice(sb, cstr, strlen(cstr));
 }
 
+SBVDEF ptrdiff_t sb_append_cstr_z(sb_t *sb, const char *cstr)
+{
+    if (cstr == NULL) return -1;
+    return sb_append_slice_z(sb, cstr, strlen(cstr));
+}
+
 SBVDEF int sb_append_char(sb_t *sb, char c)
 {
     if (sb == NULL) return -1;
@@ -388,58 +1275,100 @@ SBVDEF int sb_append_null(sb_t *sb)
     return 0;
 }
 
-SBVDEF int sb_append_file(sb_t *sb, const char *filename)
+#define SBV__FILE_CHUNK (64u * 1024)
+
+// append a file's content, failing without appending anything if it is longer than `limit` bytes
+// the size of a seekable file is checked before anything is reserved or read, other streams stop reading past the limit
+static inline ptrdiff_t sbv__append_file(sb_t *sb, const char *filename, size_t limit)
 {
     if (sb == NULL || filename == NULL) return -1;
 
     FILE *file = fopen(filename, "rb");
     if (file == NULL) return -1;
 
-    char buffer[4096];
-    size_t n;
-    size_t bytes_written = 0;
+    size_t start = sb->count;
 
-    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0){
-        int bytes = sb_append_slice(sb, buffer, n);
-        if (bytes == -1){
-            sb_pop(sb, bytes_written);
-            fclose(file);
-            return -1;
-        }
-        bytes_written += (size_t) bytes;
+    // reserve the file size up front when it is known, one byte more so the end of the file is seen without growing
+    if (fseek(file, 0, SEEK_END) == 0){
+        long size = ftell(file);
+        if (size > 0 && (unsigned long) size > limit) goto error;
+        if (size > 0 && !sb_reserve(sb, (size_t) size + 1)) goto error;
+        if (fseek(file, 0, SEEK_SET) != 0) goto error;
     }
-    if (ferror(file)){
-        sb_pop(sb, bytes_written);
-        fclose(file);
-        return -1;
+
+    // read straight into the builder
+    for (;;){
+        if (sb->capacity <= sb->count + 1 && !sb_reserve(sb, SBV__FILE_CHUNK)) goto error;
+        size_t room = sb->capacity - sb->count - 1;
+        size_t n = fread(sb->items + sb->count, 1, room, file);
+        sb->count += n;
+        if (sb->count - start > limit) goto error;
+        if (n < room) break;
     }
+    if (ferror(file)) goto error;
+
     fclose(file);
-    return bytes_written;
+    return (ptrdiff_t)(sb->count - start);
+
+error:
+    sb->count = start;
+    fclose(file);
+    return -1;
+}
+
+SBVDEF int sb_append_file(sb_t *sb, const char *filename)
+{
+    return (int) sbv__append_file(sb, filename, INT_MAX);
+}
+
+SBVDEF ptrdiff_t sb_append_file_z(sb_t *sb, const char *filename)
+{
+    return sbv__append_file(sb, filename, PTRDIFF_MAX);
 }
 
 SBVDEF int sb_pop(sb_t *sb, size_t n)
+{
+    if (sb == NULL || SBV_MIN(sb->count, n) > INT_MAX) return -1;
+    return (int) sb_pop_z(sb, n);
+}
+
+SBVDEF ptrdiff_t sb_pop_z(sb_t *sb, size_t n)
 {
     if (sb == NULL) return -1;
 
     size_t bytes = SBV_MIN(sb->count, n);
     sb->count -= bytes;
-    return bytes;
+    return (ptrdiff_t) bytes;
 }
 
 SBVDEF int sb_extract(const sb_t *sb, char *buff, size_t buff_size)
 {
+    if (sb == NULL) return -1;
     return sb_extract_slice(sb, sb->count, buff, buff_size);
 }
 
 SBVDEF int sb_extract_slice(const sb_t *sb, size_t n, char *buff, size_t buff_size)
+{
+    if (sb == NULL || SBV_MIN(SBV_MIN(sb->count, n), buff_size) >= INT_MAX) return -1;
+    return (int) sb_extract_slice_z(sb, n, buff, buff_size);
+}
+
+SBVDEF ptrdiff_t sb_extract_z(const sb_t *sb, char *buff, size_t buff_size)
+{
+    if (sb == NULL) return -1;
+    return sb_extract_slice_z(sb, sb->count, buff, buff_size);
+}
+
+SBVDEF ptrdiff_t sb_extract_slice_z(const sb_t *sb, size_t n, char *buff, size_t buff_size)
 {
     if (sb == NULL) return -1;
     if (buff_size == 0) return 0;
 
     size_t bytes_to_write = SBV_MIN(SBV_MIN(sb->count, n), buff_size-1);
+    if (bytes_to_write >= (size_t) PTRDIFF_MAX) return -1;
     (void) memcpy(buff, sb->items, bytes_to_write);
     buff[bytes_to_write] = '\0';
-    return bytes_to_write + 1;
+    return (ptrdiff_t) bytes_to_write + 1;
 }
 
 SBVDEF char* sb_to_cstr(const sb_t *sb)
@@ -462,6 +1391,15 @@ SBVDEF char* sb_detach(sb_t *sb)
     if (sb_append_null(sb) == -1 && sb->items != NULL){
         sb->items[sb->count] = '\0';
     }
+#ifdef SBV__MMAP
+    // a mapped buffer can not be released with SBV_FREE, so hand off a heap copy instead
+    if (sbv__buffer_mapped(sb->capacity)){
+        char *content = sb_to_cstr(sb);
+        if (content == NULL) return NULL;
+        sb_free(sb);
+        return content;
+    }
+#endif // SBV__MMAP
     char *content = sb->items;
 
     sb->items = NULL;
@@ -476,13 +1414,117 @@ SBVDEF void sb_clear(sb_t *sb)
     sb->count = 0;
 }
 
+SBVDEF bool sb_shrink_to_fit(sb_t *sb)
+{
+    if (sb == NULL) return false;
+    if (sb->count == 0){
+        sb_free(sb);
+        return true;
+    }
+    size_t capacity = sbv__buffer_capacity(sb->count + 1);
+    if (capacity >= sb->capacity) return true;
+
+    char *new_items = sbv__buffer_resize(sb->items, sb->capacity, sb->count, capacity);
+    if (new_items == NULL) return false;
+
+    sb->items = new_items;
+    sb->capacity = capacity;
+    return true;
+}
+
+#ifdef SBV_POOL
+SBVDEF sb_t sb_pool_acquire(size_t capacity)
+{
+    sb_t sb = sb_null();
+    if (!sb_reserve(&sb, capacity)) return sb_null();
+    return sb;
+}
+#endif // SBV_POOL
+
 SBVDEF void sb_free(sb_t *sb)
 {
     if (sb == NULL) return;
-    SBV_FREE(sb->items);
+    sbv__buffer_free(sb->items, sb->capacity);
+    sb->items = NULL;
+    sb->count = sb->capacity = 0;
+}
+
+#ifdef SBV__HAS_ATOMICS
+struct sbv__shared {
+    SBV__ATOMIC(size_t) refs;
+    char *items;
+    size_t capacity;
+};
+
+#define SBV__SHARED_ALIGN 16
+
+SBVDEF sv_shared_t sb_freeze(sb_t *sb)
+{
+    sv_shared_t shared = {0};
+    if (sb == NULL) return shared;
+    if (sb->items == NULL){
+        shared.items = "";
+        return shared;
+    }
+
+    // the control block lives in the unused tail of the buffer when it fits, and is allocated otherwise
+    struct sbv__shared *owner = NULL;
+    uintptr_t tail = ((uintptr_t)(sb->items + sb->count) + SBV__SHARED_ALIGN - 1) & ~(uintptr_t)(SBV__SHARED_ALIGN - 1);
+    if (tail + sizeof(*owner) <= (uintptr_t)(sb->items + sb->capacity)){
+        owner = (struct sbv__shared*) tail;
+    } else{
+        owner = SBV_MALLOC(sizeof(*owner));
+        if (owner == NULL) return shared;
+    }
+    owner->refs = 1;
+    owner->items = sb->items;
+    owner->capacity = sb->capacity;
+
+    shared.items = sb->items;
+    shared.len = sb->count;
+    shared.owner = owner;
+
     sb->items = NULL;
     sb->count = sb->capacity = 0;
+    return shared;
+}
+
+SBVDEF sv_shared_t sv_shared_retain(sv_shared_t shared)
+{
+    if (shared.owner) (void) SBV__ATOMIC_FETCH_ADD(&shared.owner->refs, 1);
+    return shared;
+}
+
+SBVDEF sv_shared_t sv_shared_slice(sv_shared_t shared, size_t start, size_t len)
+{
+    if (start > shared.len) start = shared.len;
+    if (len > shared.len - start) len = shared.len - start;
+    shared.items += start;
+    shared.len = len;
+    return sv_shared_retain(shared);
+}
+
+SBVDEF void sv_shared_release(sv_shared_t *shared)
+{
+    if (shared == NULL) return;
+    struct sbv__shared *owner = shared->owner;
+    memset(shared, 0, sizeof(*shared));
+    if (owner == NULL || SBV__ATOMIC_FETCH_SUB(&owner->refs, 1) != 1) return;
+
+    sb_t sb = {
+        .items = owner->items,
+        .capacity = owner->capacity,
+    };
+    bool embedded = (char*) owner >= sb.items && (char*) owner < sb.items + sb.capacity;
+    if (!embedded) SBV_FREE(owner);
+    sb_free(&sb);
+}
+
+SBVDEF sv_t sv_from_shared(sv_shared_t shared)
+{
+    return sv_from_slice(shared.items, shared.len);
 }
+#endif // SBV__HAS_ATOMICS
 
 SBVDEF sv_t sv_from_slice(const char *buff, size_t n)
 {
@@ -1012,13 +2054,20 @@ SBVDEF size_t sv_replace_len(sv_t sv, sv_t query, sv_t replace)
 }
 
 SBVDEF int sv_extract(sv_t sv, char *buff, size_t buff_size)
+{
+    if (SBV_MIN(sv.len, buff_size) >= INT_MAX) return -1;
+    return (int) sv_extract_z(sv, buff, buff_size);
+}
+
+SBVDEF ptrdiff_t sv_extract_z(sv_t sv, char *buff, size_t buff_size)
 {
     if (buff == NULL || sv_isnull(sv)) return -1;
     if (buff_size == 0) return 0;
     size_t bytes_to_write = SBV_MIN(sv.len, buff_size-1);
+    if (bytes_to_write >= (size_t) PTRDIFF_MAX) return -1;
     (void) memcpy(buff, sv.items, bytes_to_write);
     buff[bytes_to_write] = '\0';
-    return bytes_to_write + 1;
+    return (ptrdiff_t) bytes_to_write + 1;
 }
 
 SBVDEF char* sv_to_cstr(sv_t sv)
@@ -1038,4 +2087,3168 @@ SBVDEF char* sv_to_cstr(sv_t sv)
     return cstr;
 }
 
-#endif // SBV_IMPLEMENTATION
+SBVDEF int sb_append_json_escaped(sb_t *sb, sv_t sv)
+{
+    if (sb == NULL || sv.items == NULL) return -1;
+    if (sv.len > (SIZE_MAX - 1) / 6) return -1;
+
+    // count the extra bytes of the escapes first, skipping clean blocks 8 bytes at a time
+    size_t extra = 0;
+    for (size_t i=0; i<sv.len;){
+        if (i + 8 <= sv.len){
+            uint64_t v = sbv__load64(sv.items + i);
+            if (!(SBV__HAS_LESS(v, 0x20) | SBV__HAS_BYTE(v, '"') | SBV__HAS_BYTE(v, '\\'))){
+                i += 8;
+                continue;
+            }
+        }
+        unsigned char c = (unsigned char) sv.items[i++];
+        if (c == '"' || c == '\\' || c == '\b' || c == '\f' || c == '\n' || c == '\r' || c == '\t') extra += 1;
+        else if (c < 0x20) extra += 5;
+    }
+    if (sv.len + extra > INT_MAX || !sb_reserve(sb, sv.len + extra)) return -1;
+
+    char *out = sb->items + sb->count;
+    size_t i = 0;
+    while (i < sv.len){
+        size_t start = i;
+        while (i + 8 <= sv.len){
+            uint64_t v = sbv__load64(sv.items + i);
+            if (SBV__HAS_LESS(v, 0x20) | SBV__HAS_BYTE(v, '"') | SBV__HAS_BYTE(v, '\\')) break;
+            i += 8;
+        }
+        while (i < sv.len){
+            unsigned char c = (unsigned char) sv.items[i];
+            if (c < 0x20 || c == '"' || c == '\\') break;
+            i += 1;
+        }
+        (void) memcpy(out, sv.items + start, i - start);
+        out += i - start;
+        if (i == sv.len) break;
+
+        unsigned char c = (unsigned char) sv.items[i++];
+        *out++ = '\\';
+        switch (c){
+            case '"':  *out++ = '"';  break;
+            case '\\': *out++ = '\\'; break;
+            case '\b': *out++ = 'b';  break;
+            case '\f': *out++ = 'f';  break;
+            case '\n': *out++ = 'n';  break;
+            case '\r': *out++ = 'r';  break;
+            case '\t': *out++ = 't';  break;
+            default:
+                *out++ = 'u';
+                *out++ = '0';
+                *out++ = '0';
+                *out++ = sbv__hex_digits[c >> 4];
+                *out++ = sbv__hex_digits[c & 0xF];
+        }
+    }
+    size_t n = (size_t)(out - (sb->items + sb->count));
+    sb->count += n;
+    return n;
+}
+
+// bitmap of the RFC 3986 unreserved characters: ALPHA, DIGIT, '-', '.', '_' and '~'
+static const uint32_t sbv__url_unreserved[8] = {
+    0x00000000, 0x03FF6000, 0x87FFFFFE, 0x47FFFFFE,
+    0x00000000, 0x00000000, 0x00000000, 0x00000000
+};
+
+SBVDEF int sb_append_url_encoded(sb_t *sb, sv_t sv)
+{
+    if (sb == NULL || sv.items == NULL) return -1;
+    if (sv.len > (SIZE_MAX - 1) / 3) return -1;
+    if (!sb_reserve(sb, sv.len * 3)) return -1;
+
+    char *out = sb->items + sb->count;
+    size_t i = 0;
+    while (i < sv.len){
+        size_t start = i;
+        while (i < sv.len){
+            unsigned char c = (unsigned char) sv.items[i];
+            if (!(sbv__url_unreserved[c >> 5] & (1u << (c & 31)))) break;
+            i += 1;
+        }
+        (void) memcpy(out, sv.items + start, i - start);
+        out += i - start;
+        if (i == sv.len) break;
+
+        unsigned char c = (unsigned char) sv.items[i++];
+        *out++ = '%';
+        *out++ = sbv__hex_digits[c >> 4];
+        *out++ = sbv__hex_digits[c & 0xF];
+    }
+    size_t n = (size_t)(out - (sb->items + sb->count));
+    if (n > INT_MAX) return -1; // the output is past the content, so nothing was appended
+    sb->count += n;
+    return n;
+}
+
+SBVDEF int sb_append_c_escaped(sb_t *sb, sv_t sv)
+{
+    if (sb == NULL || sv.items == NULL) return -1;
+    if (sv.len > (SIZE_MAX - 1) / 4) return -1;
+    if (!sb_reserve(sb, sv.len * 4)) return -1;
+
+    char *out = sb->items + sb->count;
+    size_t i = 0;
+    while (i < sv.len){
+        size_t start = i;
+        while (i + 8 <= sv.len){
+            uint64_t v = sbv__load64(sv.items + i);
+            if ((v & SBV__HIGHS) | SBV__HAS_LESS(v, 0x20) | SBV__HAS_BYTE(v, 0x7F) |
+                SBV__HAS_BYTE(v, '"') | SBV__HAS_BYTE(v, '\\')) break;
+            i += 8;
+        }
+        while (i < sv.len){
+            unsigned char c = (unsigned char) sv.items[i];
+            if (c < 0x20 || c >= 0x7F || c == '"' || c == '\\') break;
+            i += 1;
+        }
+        (void) memcpy(out, sv.items + start, i - start);
+        out += i - start;
+        if (i == sv.len) break;
+
+        unsigned char c = (unsigned char) sv.items[i++];
+        *out++ = '\\';
+        switch (c){
+            case '"':  *out++ = '"';  break;
+            case '\\': *out++ = '\\'; break;
+            case '\a': *out++ = 'a';  break;
+            case '\b': *out++ = 'b';  break;
+            case '\f': *out++ = 'f';  break;
+            case '\n': *out++ = 'n';  break;
+            case '\r': *out++ = 'r';  break;
+            case '\t': *out++ = 't';  break;
+            case '\v': *out++ = 'v';  break;
+            default:
+                // always three octal digits, so a following digit can not extend the escape
+                *out++ = '0' + (c >> 6);
+                *out++ = '0' + ((c >> 3) & 7);
+                *out++ = '0' + (c & 7);
+        }
+    }
+    size_t n = (size_t)(out - (sb->items + sb->count));
+    if (n > INT_MAX) return -1;
+    sb->count += n;
+    return n;
+}
+
+SBVDEF int sb_append_shell_escaped(sb_t *sb, sv_t sv)
+{
+    if (sb == NULL || sv.items == NULL) return -1;
+    if (sv.len > (SIZE_MAX - 3) / 4) return -1;
+
+    size_t quotes = 0;
+    for (const char *q = sv.items; (q = memchr(q, '\'', sv.len - (size_t)(q - sv.items))) != NULL; ++q){
+        quotes += 1;
+    }
+    size_t total = sv.len + 3 * quotes + 2;
+    if (total > INT_MAX || !sb_reserve(sb, total)) return -1;
+
+    char *out = sb->items + sb->count;
+    *out++ = '\'';
+    size_t i = 0;
+    while (i < sv.len){
+        const char *quote = memchr(sv.items + i, '\'', sv.len - i);
+        size_t end = quote ? (size_t)(quote - sv.items) : sv.len;
+        (void) memcpy(out, sv.items + i, end - i);
+        out += end - i;
+        i = end;
+        if (i == sv.len) break;
+
+        // close the quoted part, add an escaped quote and reopen it
+        (void) memcpy(out, "'\\''", 4);
+        out += 4;
+        i += 1;
+    }
+    *out++ = '\'';
+
+    sb->count += total;
+    return total;
+}
+
+SBVDEF int sb_append_url_decoded(sb_t *sb, sv_t sv, size_t *error_offset)
+{
+    if (sb == NULL || sv.items == NULL) return -1;
+    if (!sb_reserve(sb, sv.len)) return -1;
+
+    char *out = sb->items + sb->count;
+    size_t i = 0;
+    while (i < sv.len){
+        const char *percent = memchr(sv.items + i, '%', sv.len - i);
+        size_t end = percent ? (size_t)(percent - sv.items) : sv.len;
+        (void) memcpy(out, sv.items + i, end - i);
+        out += end - i;
+        i = end;
+        if (i == sv.len) break;
+
+        int hi = (i + 1 < sv.len) ? sbv__hex_value(sv.items[i + 1]) : -1;
+        int lo = (i + 2 < sv.len) ? sbv__hex_value(sv.items[i + 2]) : -1;
+        if (hi < 0 || lo < 0){
+            if (error_offset) *error_offset = i;
+            return -1;
+        }
+        *out++ = (char)((hi << 4) | lo);
+        i += 3;
+    }
+    size_t n = (size_t)(out - (sb->items + sb->count));
+    if (n > INT_MAX) return -1;
+    sb->count += n;
+    return n;
+}
+
+SBVDEF int sb_append_c_unescaped(sb_t *sb, sv_t sv, size_t *error_offset)
+{
+    if (sb == NULL || sv.items == NULL) return -1;
+    if (!sb_reserve(sb, sv.len)) return -1;
+
+    char *out = sb->items + sb->count;
+    size_t i = 0;
+    while (i < sv.len){
+        const char *backslash = memchr(sv.items + i, '\\', sv.len - i);
+        size_t end = backslash ? (size_t)(backslash - sv.items) : sv.len;
+        (void) memcpy(out, sv.items + i, end - i);
+        out += end - i;
+        i = end;
+        if (i == sv.len) break;
+
+        size_t escape = i++;
+        if (i == sv.len){
+            if (error_offset) *error_offset = escape;
+            return -1;
+        }
+        char c = sv.items[i++];
+        switch (c){
+            case '"':  *out++ = '"';  break;
+            case '\'': *out++ = '\''; break;
+            case '?':  *out++ = '?';  break;
+            case '\\': *out++ = '\\'; break;
+            case 'a':  *out++ = '\a'; break;
+            case 'b':  *out++ = '\b'; break;
+            case 'f':  *out++ = '\f'; break;
+            case 'n':  *out++ = '\n'; break;
+            case 'r':  *out++ = '\r'; break;
+            case 't':  *out++ = '\t'; break;
+            case 'v':  *out++ = '\v'; break;
+            case 'x': {
+                unsigned value = 0;
+                size_t digits = 0;
+                int d;
+                while (i < sv.len && (d = sbv__hex_value(sv.items[i])) >= 0){
+                    value = (value << 4) | (unsigned) d;
+                    if (value > 0xFF){
+                        if (error_offset) *error_offset = escape;
+                        return -1;
+                    }
+                    digits += 1;
+                    i += 1;
+                }
+                if (digits == 0){
+                    if (error_offset) *error_offset = escape;
+                    return -1;
+                }
+                *out++ = (char) value;
+            } break;
+            default:
+                if (c >= '0' && c <= '7'){
+                    unsigned value = (unsigned)(c - '0');
+                    for (size_t digits = 1; digits < 3 && i < sv.len && sv.items[i] >= '0' && sv.items[i] <= '7'; ++digits){
+                        value = (value << 3) | (unsigned)(sv.items[i++] - '0');
+                    }
+                    if (value > 0xFF){
+                        if (error_offset) *error_offset = escape;
+                        return -1;
+                    }
+                    *out++ = (char) value;
+                } else{
+                    if (error_offset) *error_offset = escape;
+                    return -1;
+                }
+        }
+    }
+    size_t n = (size_t)(out - (sb->items + sb->count));
+    if (n > INT_MAX) return -1;
+    sb->count += n;
+    return n;
+}
+
+static const char sbv__base64_digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static const char sbv__base64url_digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+// value of every byte in the base64 alphabet, 0xFF for bytes outside of it
+static const unsigned char sbv__base64_values[256] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF, 0xFF, 0x3F,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+    0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+// same for the base64url alphabet
+static const unsigned char sbv__base64url_values[256] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+    0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0x3F,
+    0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+// value of every hex digit, 0xFF for non-hex bytes
+static const unsigned char sbv__hex_values[256] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+SBVDEF int sb_append_base64_encoded(sb_t *sb, sv_t sv, int flags)
+{
+    if (sb == NULL || sv.items == NULL) return -1;
+    if (sv.len / 3 >= SIZE_MAX / 4) return -1;
+
+    bool pad = !(flags & SB_BASE64_NO_PAD);
+    size_t tail = sv.len % 3;
+    size_t total = sv.len / 3 * 4 + (tail == 0 ? 0 : pad ? 4 : tail + 1);
+    if (total > INT_MAX || !sb_reserve(sb, total)) return -1;
+
+    const char *digits = (flags & SB_BASE64_URL) ? sbv__base64url_digits : sbv__base64_digits;
+    const unsigned char *in = (const unsigned char*) sv.items;
+    char *out = sb->items + sb->count;
+    size_t i = 0;
+    // 6 input bytes at a time become 8 output bytes
+    for (; i + 6 <= sv.len; i += 6){
+        uint64_t v = (uint64_t) in[i] << 40 | (uint64_t) in[i+1] << 32 | (uint64_t) in[i+2] << 24 |
+                     (uint64_t) in[i+3] << 16 | (uint64_t) in[i+4] << 8 | (uint64_t) in[i+5];
+        out[0] = digits[(v >> 42) & 0x3F];
+        out[1] = digits[(v >> 36) & 0x3F];
+        out[2] = digits[(v >> 30) & 0x3F];
+        out[3] = digits[(v >> 24) & 0x3F];
+        out[4] = digits[(v >> 18) & 0x3F];
+        out[5] = digits[(v >> 12) & 0x3F];
+        out[6] = digits[(v >> 6) & 0x3F];
+        out[7] = digits[v & 0x3F];
+        out += 8;
+    }
+    for (; i + 3 <= sv.len; i += 3){
+        uint32_t v = (uint32_t) in[i] << 16 | (uint32_t) in[i+1] << 8 | (uint32_t) in[i+2];
+        out[0] = digits[(v >> 18) & 0x3F];
+        out[1] = digits[(v >> 12) & 0x3F];
+        out[2] = digits[(v >> 6) & 0x3F];
+        out[3] = digits[v & 0x3F];
+        out += 4;
+    }
+    if (tail > 0){
+        uint32_t v = (uint32_t) in[i] << 16 | (tail > 1 ? (uint32_t) in[i+1] << 8 : 0);
+        *out++ = digits[(v >> 18) & 0x3F];
+        *out++ = digits[(v >> 12) & 0x3F];
+        if (tail > 1) *out++ = digits[(v >> 6) & 0x3F];
+        else if (pad) *out++ = '=';
+        if (pad) *out++ = '=';
+    }
+
+    sb->count += total;
+    return total;
+}
+
+SBVDEF int sb_append_base64_decoded(sb_t *sb, sv_t sv, int flags, size_t *error_offset)
+{
+    if (sb == NULL || sv.items == NULL) return -1;
+
+    const unsigned char *values = (flags & SB_BASE64_URL) ? sbv__base64url_values : sbv__base64_values;
+
+    // split off the last group, which may be short or padded
+    size_t len = sv.len;
+    size_t tail = len % 4;
+    if (!(flags & SB_BASE64_NO_PAD)){
+        if (tail != 0){
+            if (error_offset) *error_offset = len;
+            return -1;
+        }
+        if (len > 0 && sv.items[len - 1] == '='){
+            len -= 1;
+            tail = 3;
+            if (sv.items[len - 1] == '='){
+                len -= 1;
+                tail = 2;
+            }
+            len -= tail;
+        }
+    } else{
+        len -= tail;
+    }
+    if (tail == 1){
+        if (error_offset) *error_offset = sv.len;
+        return -1;
+    }
+
+    if (!sb_reserve(sb, len / 4 * 3 + 2)) return -1;
+
+    const unsigned char *in = (const unsigned char*) sv.items;
+    char *out = sb->items + sb->count;
+    size_t i = 0;
+    for (; i < len; i += 4){
+        uint32_t a = values[in[i]], b = values[in[i+1]], c = values[in[i+2]], d = values[in[i+3]];
+        // invalid bytes set the high bits, so one test covers the whole group
+        if ((a | b | c | d) & 0x80) break;
+        uint32_t v = a << 18 | b << 12 | c << 6 | d;
+        out[0] = (char)(v >> 16);
+        out[1] = (char)(v >> 8);
+        out[2] = (char) v;
+        out += 3;
+    }
+    if (i < len){
+        while (values[in[i]] != 0xFF) i += 1;
+        if (error_offset) *error_offset = i;
+        return -1;
+    }
+    if (tail > 0){
+        for (size_t j=i; j<i+tail; ++j){
+            if (values[in[j]] == 0xFF){
+                if (error_offset) *error_offset = j;
+                return -1;
+            }
+        }
+        uint32_t v = (uint32_t) values[in[i]] << 18 | (uint32_t) values[in[i+1]] << 12 |
+                     (tail > 2 ? (uint32_t) values[in[i+2]] << 6 : 0);
+        *out++ = (char)(v >> 16);
+        if (tail > 2) *out++ = (char)(v >> 8);
+    }
+
+    size_t n = (size_t)(out - (sb->items + sb->count));
+    if (n > INT_MAX) return -1;
+    sb->count += n;
+    return n;
+}
+
+SBVDEF int sb_append_hex_encoded(sb_t *sb, sv_t sv)
+{
+    if (sb == NULL || sv.items == NULL) return -1;
+    if (sv.len > INT_MAX / 2) return -1;
+    if (!sb_reserve(sb, sv.len * 2)) return -1;
+
+    static const char digits[] = "0123456789abcdef";
+    const unsigned char *in = (const unsigned char*) sv.items;
+    char *out = sb->items + sb->count;
+    for (size_t i=0; i<sv.len; ++i){
+        out[2*i] = digits[in[i] >> 4];
+        out[2*i + 1] = digits[in[i] & 0xF];
+    }
+
+    sb->count += sv.len * 2;
+    return sv.len * 2;
+}
+
+SBVDEF int sb_append_hex_decoded(sb_t *sb, sv_t sv, size_t *error_offset)
+{
+    if (sb == NULL || sv.items == NULL) return -1;
+
+    const unsigned char *values = sbv__hex_values;
+
+    if (sv.len / 2 > INT_MAX || !sb_reserve(sb, sv.len / 2)) return -1;
+
+    const unsigned char *in = (const unsigned char*) sv.items;
+    char *out = sb->items + sb->count;
+    size_t i = 0;
+    for (; i + 2 <= sv.len; i += 2){
+        unsigned hi = values[in[i]], lo = values[in[i+1]];
+        if ((hi | lo) & 0x80){
+            if (error_offset) *error_offset = (hi & 0x80) ? i : i + 1;
+            return -1;
+        }
+        *out++ = (char)(hi << 4 | lo);
+    }
+    if (i < sv.len){
+        if (error_offset) *error_offset = values[in[i]] == 0xFF ? i : sv.len;
+        return -1;
+    }
+
+    sb->count += sv.len / 2;
+    return sv.len / 2;
+}
+
+#ifdef SBV_THREADS
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+#define SBV__READER_ALIGN 4096 // O_DIRECT needs block-aligned buffers, sizes and offsets
+
+struct sv_reader {
+    int fd;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t filled_cond;  // signaled by the reader thread when a block was filled
+    pthread_cond_t free_cond;    // signaled by the consumer when a block was released
+    char *allocation;
+    char *blocks;
+    size_t *lens;
+    size_t block_size;
+    size_t block_count;
+    size_t filled;               // number of blocks filled so far
+    size_t consumed;             // number of blocks handed to the consumer so far
+    size_t released;             // number of blocks released by the consumer so far
+    bool done;                   // the reader thread hit the end of the file or an error
+    bool failed;
+    bool stop;
+    // consumer state
+    bool split;
+    char delimiter;
+    bool holding;                // the consumer holds block `consumed - 1`
+    sv_t rest;                   // part of the held block that has not been handed out yet
+    sb_t carry;                  // record spanning a block boundary
+    bool carry_out;              // `carry` was handed out by the last call
+};
+
+static inline void* sbv__reader_thread(void *arg)
+{
+    sv_reader_t *r = arg;
+    for (;;){
+        pthread_mutex_lock(&r->lock);
+        while (r->filled - r->released >= r->block_count && !r->stop){
+            pthread_cond_wait(&r->free_cond, &r->lock);
+        }
+        bool stop = r->stop;
+        size_t index = r->filled % r->block_count;
+        pthread_mutex_unlock(&r->lock);
+        if (stop) break;
+
+        char *block = r->blocks + index * r->block_size;
+        size_t n = 0;
+        bool failed = false;
+        while (n < r->block_size){
+            ssize_t bytes = read(r->fd, block + n, r->block_size - n);
+            if (bytes < 0 && errno == EINTR) continue;
+            if (bytes < 0) failed = true;
+            if (bytes <= 0) break;
+            n += (size_t) bytes;
+        }
+
+        pthread_mutex_lock(&r->lock);
+        if (n > 0 && !failed){
+            r->lens[index] = n;
+            r->filled += 1;
+        }
+        r->failed = failed;
+        r->done = failed || n < r->block_size;
+        pthread_cond_signal(&r->filled_cond);
+        pthread_mutex_unlock(&r->lock);
+        if (r->done) break;
+    }
+    return NULL;
+}
+
+SBVDEF sv_reader_t* sv_reader_open(const char *filename, const sv_reader_opts_t *opts)
+{
+    if (filename == NULL) return NULL;
+    sv_reader_opts_t o = {0};
+    if (opts != NULL) o = *opts;
+#ifndef O_DIRECT
+    if (o.direct) return NULL;
+#endif // O_DIRECT
+    if (o.block_size == 0) o.block_size = SV_READER_BLOCK_SIZE;
+    if (o.block_count == 0) o.block_count = SV_READER_BLOCK_COUNT;
+    if (o.block_size > (SIZE_MAX - SBV__READER_ALIGN) / 2) return NULL;
+    o.block_size = (o.block_size + SBV__READER_ALIGN - 1) / SBV__READER_ALIGN * SBV__READER_ALIGN;
+    if (o.block_count > (SIZE_MAX - SBV__READER_ALIGN) / o.block_size) return NULL;
+
+    sv_reader_t *r = SBV_MALLOC(sizeof(*r));
+    if (r == NULL) return NULL;
+    memset(r, 0, sizeof(*r));
+    r->block_size = o.block_size;
+    r->block_count = o.block_count;
+    r->split = o.split;
+    r->delimiter = o.delimiter;
+
+    r->fd = -1;
+#ifdef O_DIRECT
+    if (o.direct) r->fd = open(filename, O_RDONLY | O_DIRECT);
+#endif // O_DIRECT
+    if (r->fd < 0) r->fd = open(filename, O_RDONLY);
+    if (r->fd < 0){
+        SBV_FREE(r);
+        return NULL;
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    (void) posix_fadvise(r->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif // POSIX_FADV_SEQUENTIAL
+
+    r->allocation = SBV_MALLOC(r->block_size * r->block_count + SBV__READER_ALIGN);
+    r->lens = SBV_MALLOC(sizeof(*r->lens) * r->block_count);
+    if (r->allocation == NULL || r->lens == NULL) goto error;
+    r->blocks = (char*)(((uintptr_t) r->allocation + SBV__READER_ALIGN - 1) & ~(uintptr_t)(SBV__READER_ALIGN - 1));
+
+    if (pthread_mutex_init(&r->lock, NULL) != 0) goto error;
+    if (pthread_cond_init(&r->filled_cond, NULL) != 0){
+        pthread_mutex_destroy(&r->lock);
+        goto error;
+    }
+    if (pthread_cond_init(&r->free_cond, NULL) != 0){
+        pthread_cond_destroy(&r->filled_cond);
+        pthread_mutex_destroy(&r->lock);
+        goto error;
+    }
+    if (pthread_create(&r->thread, NULL, sbv__reader_thread, r) != 0){
+        pthread_cond_destroy(&r->free_cond);
+        pthread_cond_destroy(&r->filled_cond);
+        pthread_mutex_destroy(&r->lock);
+        goto error;
+    }
+    return r;
+
+error:
+    close(r->fd);
+    SBV_FREE(r->allocation);
+    SBV_FREE(r->lens);
+    SBV_FREE(r);
+    return NULL;
+}
+
+// release the block held by the consumer and wait for the next one
+// return the block, or sv_null if there is none left
+static inline sv_t sbv__reader_next_block(sv_reader_t *r)
+{
+    pthread_mutex_lock(&r->lock);
+    if (r->holding){
+        r->released += 1;
+        r->holding = false;
+        pthread_cond_signal(&r->free_cond);
+    }
+    while (r->consumed == r->filled && !r->done){
+        pthread_cond_wait(&r->filled_cond, &r->lock);
+    }
+    sv_t block = sv_null();
+    if (r->consumed < r->filled){
+        size_t index = r->consumed % r->block_count;
+        block = sv_from_slice(r->blocks + index * r->block_size, r->lens[index]);
+        r->consumed += 1;
+        r->holding = true;
+    }
+    pthread_mutex_unlock(&r->lock);
+    return block;
+}
+
+SBVDEF sv_t sv_reader_next(sv_reader_t *r)
+{
+    if (r == NULL) return sv_null();
+    if (!r->split) return sbv__reader_next_block(r);
+
+    if (r->carry_out){
+        sb_clear(&r->carry);
+        r->carry_out = false;
+    }
+    for (;;){
+        if (r->rest.len > 0){
+            size_t end = r->rest.len;
+            while (end > 0 && r->rest.items[end - 1] != r->delimiter) end -= 1;
+            if (end > 0){
+                sv_t chunk = sv_slice(r->rest, 0, end);
+                r->rest = sv_chop_left(r->rest, end);
+                return chunk;
+            }
+            if (sb_append_sv(&r->carry, r->rest) < 0) goto error;
+            r->rest = sv_null();
+        }
+
+        sv_t block = sbv__reader_next_block(r);
+        if (sv_isnull(block)){
+            if (r->carry.count == 0) return sv_null();
+            r->carry_out = true;
+            return sv_from_sb(&r->carry);
+        }
+        if (r->carry.count == 0){
+            r->rest = block;
+            continue;
+        }
+        const char *del = memchr(block.items, r->delimiter, block.len);
+        if (del == NULL){
+            if (sb_append_sv(&r->carry, block) < 0) goto error;
+            continue;
+        }
+        size_t head = (size_t)(del - block.items) + 1;
+        if (sb_append_slice(&r->carry, block.items, head) < 0) goto error;
+        r->rest = sv_chop_left(block, head);
+        r->carry_out = true;
+        return sv_from_sb(&r->carry);
+    }
+
+error:
+    pthread_mutex_lock(&r->lock);
+    r->failed = true;
+    pthread_mutex_unlock(&r->lock);
+    return sv_null();
+}
+
+SBVDEF bool sv_reader_failed(const sv_reader_t *r)
+{
+    if (r == NULL) return true;
+    pthread_mutex_lock((pthread_mutex_t*) &r->lock);
+    bool failed = r->failed;
+    pthread_mutex_unlock((pthread_mutex_t*) &r->lock);
+    return failed;
+}
+
+SBVDEF void sv_reader_close(sv_reader_t *r)
+{
+    if (r == NULL) return;
+    pthread_mutex_lock(&r->lock);
+    r->stop = true;
+    pthread_cond_signal(&r->free_cond);
+    pthread_mutex_unlock(&r->lock);
+    pthread_join(r->thread, NULL);
+
+    pthread_cond_destroy(&r->free_cond);
+    pthread_cond_destroy(&r->filled_cond);
+    pthread_mutex_destroy(&r->lock);
+    close(r->fd);
+    sb_free(&r->carry);
+    SBV_FREE(r->allocation);
+    SBV_FREE(r->lens);
+    SBV_FREE(r);
+}
+#endif // SBV_THREADS
+
+// the sort is a multikey quicksort on 8-byte chunks of the string views
+// every item caches the chunk at the current depth as a big-endian integer, so partitioning never touches the strings
+typedef struct {
+    uint64_t key;  // the next (up to) 8 bytes, zero padded
+    size_t rest;   // bytes left from the current depth, capped at 9 (more than one chunk)
+    sv_t sv;
+} sbv__sort_item_t;
+
+#define SBV__SORT_INSERTION 16
+
+static inline int sbv__sort_compare_fn(const void *a, const void *b)
+{
+    return sv_compare(*(const sv_t*) a, *(const sv_t*) b);
+}
+
+static inline int sbv__sort_compare_case_fn(const void *a, const void *b)
+{
+    return sv_compare_case(*(const sv_t*) a, *(const sv_t*) b);
+}
+
+static inline void sbv__sort_load(sbv__sort_item_t *item, size_t depth, bool fold)
+{
+    size_t rest = item->sv.len - depth;
+    uint64_t key = 0;
+    if (rest >= 8){
+        const unsigned char *p = (const unsigned char*) item->sv.items + depth;
+        key = (uint64_t)p[0] << 56 | (uint64_t)p[1] << 48 | (uint64_t)p[2] << 40 | (uint64_t)p[3] << 32 |
+              (uint64_t)p[4] << 24 | (uint64_t)p[5] << 16 | (uint64_t)p[6] << 8 | (uint64_t)p[7];
+    } else{
+        for (size_t i=0; i<rest; ++i){
+            key |= (uint64_t)(unsigned char) item->sv.items[depth + i] << (56 - 8*i);
+        }
+    }
+    item->key = fold ? sbv__swar_lower(key) : key;
+    item->rest = SBV_MIN(rest, (size_t) 9);
+}
+
+static inline int sbv__sort_item_compare(const sbv__sort_item_t *a, const sbv__sort_item_t *b, size_t depth, bool fold)
+{
+    if (a->key != b->key) return a->key < b->key ? -1 : 1;
+    if (a->rest != b->rest) return a->rest < b->rest ? -1 : 1;
+    if (a->rest <= 8) return 0;
+    sv_t ra = sv_chop_left(a->sv, depth + 8);
+    sv_t rb = sv_chop_left(b->sv, depth + 8);
+    size_t n = SBV_MIN(ra.len, rb.len);
+    int result = n == 0 ? 0 : fold ? sbv_memicmp(ra.items, rb.items, n) : memcmp(ra.items, rb.items, n);
+    if (result != 0) return result;
+    return (ra.len < rb.len) ? -1 : (ra.len > rb.len);
+}
+
+static inline void sbv__sort_swap(sbv__sort_item_t *a, sbv__sort_item_t *b)
+{
+    sbv__sort_item_t t = *a;
+    *a = *b;
+    *b = t;
+}
+
+// sift an item down a max-heap of n items
+static inline void sbv__sort_sift(sbv__sort_item_t *items, size_t i, size_t n, size_t depth, bool fold)
+{
+    for (;;){
+        size_t child = 2*i + 1;
+        if (child >= n) return;
+        if (child + 1 < n && sbv__sort_item_compare(&items[child], &items[child+1], depth, fold) < 0) child += 1;
+        if (sbv__sort_item_compare(&items[i], &items[child], depth, fold) >= 0) return;
+        sbv__sort_swap(&items[i], &items[child]);
+        i = child;
+    }
+}
+
+// heapsort with the full comparison, the fallback once partitioning keeps failing
+static inline void sbv__sort_heap(sbv__sort_item_t *items, size_t n, size_t depth, bool fold)
+{
+    for (size_t i=n/2; i>0; --i) sbv__sort_sift(items, i - 1, n, depth, fold);
+    for (size_t i=n-1; i>0; --i){
+        sbv__sort_swap(&items[0], &items[i]);
+        sbv__sort_sift(items, 0, i, depth, fold);
+    }
+}
+
+// number of partitions allowed before falling back to heapsort, 2*log2(n) like introsort
+static inline size_t sbv__sort_budget(size_t n)
+{
+    size_t budget = 0;
+    while (n >>= 1) budget += 2;
+    return budget;
+}
+
+// sort items whose keys are loaded for `depth`
+// the two smaller of the three partitions are sorted recursively and the largest one in the loop,
+// so the stack depth stays logarithmic, and heapsort takes over after `budget` partitions
+static inline void sbv__sort_items(sbv__sort_item_t *items, size_t n, size_t depth, bool fold, size_t budget)
+{
+    while (n > SBV__SORT_INSERTION){
+        if (budget == 0){
+            sbv__sort_heap(items, n, depth, fold);
+            return;
+        }
+        budget -= 1;
+
+        sbv__sort_item_t *a = &items[0], *b = &items[n/2], *c = &items[n-1];
+        if (sbv__sort_item_compare(a, b, depth, fold) > 0) sbv__sort_swap(a, b);
+        if (sbv__sort_item_compare(b, c, depth, fold) > 0) sbv__sort_swap(b, c);
+        if (sbv__sort_item_compare(a, b, depth, fold) > 0) sbv__sort_swap(a, b);
+        uint64_t pivot_key = b->key;
+        size_t pivot_rest = b->rest;
+
+        // three-way partition into [0, lt) < pivot, [lt, gt) == pivot, [gt, n) > pivot on (key, rest)
+        size_t lt = 0, i = 0, gt = n;
+        while (i < gt){
+            sbv__sort_item_t *it = &items[i];
+            if (it->key < pivot_key || (it->key == pivot_key && it->rest < pivot_rest)){
+                sbv__sort_swap(&items[lt++], &items[i++]);
+            } else if (it->key > pivot_key || it->rest > pivot_rest){
+                sbv__sort_swap(&items[i], &items[--gt]);
+            } else{
+                i += 1;
+            }
+        }
+
+        // the equal items either all end within this chunk or continue with the next one
+        size_t less = lt, equal = pivot_rest > 8 ? gt - lt : 0, greater = n - gt;
+        if (equal >= less && equal >= greater){
+            sbv__sort_items(items, less, depth, fold, budget);
+            sbv__sort_items(items + gt, greater, depth, fold, budget);
+            items += lt;
+            n = equal;
+            depth += 8;
+            for (size_t k=0; k<n; ++k) sbv__sort_load(&items[k], depth, fold);
+            budget = sbv__sort_budget(n);
+            continue;
+        }
+        if (equal > 0){
+            for (size_t k=lt; k<gt; ++k) sbv__sort_load(&items[k], depth + 8, fold);
+            sbv__sort_items(items + lt, equal, depth + 8, fold, sbv__sort_budget(equal));
+        }
+        if (less < greater){
+            sbv__sort_items(items, less, depth, fold, budget);
+            items += gt;
+            n = greater;
+        } else{
+            sbv__sort_items(items + gt, greater, depth, fold, budget);
+            n = less;
+        }
+    }
+    for (size_t i=1; i<n; ++i){
+        sbv__sort_item_t item = items[i];
+        size_t j = i;
+        while (j > 0 && sbv__sort_item_compare(&items[j-1], &item, depth, fold) > 0){
+            items[j] = items[j-1];
+            j -= 1;
+        }
+        items[j] = item;
+    }
+}
+
+static inline void sbv__sort(sv_t *svs, size_t count, bool fold)
+{
+    if (svs == NULL || count < 2) return;
+
+    // null views go first, sv_compare treats them as smaller than any other view
+    size_t nulls = 0;
+    for (size_t i=0; i<count; ++i){
+        if (sv_isnull(svs[i])){
+            sv_t t = svs[nulls];
+            svs[nulls++] = svs[i];
+            svs[i] = t;
+        }
+    }
+    svs += nulls;
+    count -= nulls;
+    if (count < 2) return;
+
+    sbv__sort_item_t *items = count <= SIZE_MAX / sizeof(*items) ? SBV_MALLOC(sizeof(*items) * count) : NULL;
+    if (items == NULL){
+        qsort(svs, count, sizeof(*svs), fold ? sbv__sort_compare_case_fn : sbv__sort_compare_fn);
+        return;
+    }
+    for (size_t i=0; i<count; ++i){
+        items[i].sv = svs[i];
+        sbv__sort_load(&items[i], 0, fold);
+    }
+    sbv__sort_items(items, count, 0, fold, sbv__sort_budget(count));
+    for (size_t i=0; i<count; ++i){
+        svs[i] = items[i].sv;
+    }
+    SBV_FREE(items);
+}
+
+SBVDEF void sv_sort(sv_t *svs, size_t count)
+{
+    sbv__sort(svs, count, false);
+}
+
+SBVDEF void sv_sort_case(sv_t *svs, size_t count)
+{
+    sbv__sort(svs, count, true);
+}
+
+#ifdef SBV_THREADS
+// the parallel sort is a sample sort: the views are distributed into one bucket per thread by sampled splitters,
+// then every thread sorts its bucket with the sequential sort
+#define SBV__SORT_PARALLEL_MIN 65536
+#define SBV__SORT_MAX_THREADS 64
+#define SBV__SORT_OVERSAMPLE 32
+
+typedef struct {
+    const sv_t *svs;
+    sv_t *out;
+    size_t begin, end;      // views classified and scattered by this task
+    const sv_t *splitters;  // `buckets - 1` sorted splitters
+    size_t buckets;
+    uint8_t *bucket_of;
+    size_t counts[SBV__SORT_MAX_THREADS]; // views per bucket, turned into output offsets for the scatter
+    size_t sort_begin, sort_end;          // bucket sorted by this task
+    bool fold;
+    int phase;
+} sbv__sort_task_t;
+
+static inline void* sbv__sort_task(void *arg)
+{
+    sbv__sort_task_t *task = arg;
+    int (*compare)(sv_t, sv_t) = task->fold ? sv_compare_case : sv_compare;
+    if (task->phase == 0){
+        for (size_t i=task->begin; i<task->end; ++i){
+            size_t lo = 0, hi = task->buckets - 1;
+            while (lo < hi){
+                size_t mid = lo + (hi - lo) / 2;
+                if (compare(task->splitters[mid], task->svs[i]) <= 0) lo = mid + 1;
+                else hi = mid;
+            }
+            task->bucket_of[i] = (uint8_t) lo;
+            task->counts[lo] += 1;
+        }
+    } else if (task->phase == 1){
+        for (size_t i=task->begin; i<task->end; ++i){
+            task->out[task->counts[task->bucket_of[i]]++] = task->svs[i];
+        }
+    } else{
+        sbv__sort(task->out + task->sort_begin, task->sort_end - task->sort_begin, task->fold);
+    }
+    return NULL;
+}
+
+// run one phase of all tasks, tasks whose thread could not be started run on the calling thread
+static inline void sbv__sort_run(sbv__sort_task_t *tasks, size_t n, int phase)
+{
+    pthread_t threads[SBV__SORT_MAX_THREADS];
+    bool started[SBV__SORT_MAX_THREADS] = {0};
+    for (size_t i=0; i<n; ++i){
+        tasks[i].phase = phase;
+        if (i > 0) started[i] = pthread_create(&threads[i], NULL, sbv__sort_task, &tasks[i]) == 0;
+    }
+    for (size_t i=0; i<n; ++i){
+        if (started[i]) pthread_join(threads[i], NULL);
+        else sbv__sort_task(&tasks[i]);
+    }
+}
+
+static inline void sbv__sort_parallel(sv_t *svs, size_t count, size_t threads, bool fold)
+{
+    if (threads > SBV__SORT_MAX_THREADS) threads = SBV__SORT_MAX_THREADS;
+    if (svs == NULL || threads < 2 || count < SBV__SORT_PARALLEL_MIN){
+        sbv__sort(svs, count, fold);
+        return;
+    }
+
+    size_t samples_count = threads * SBV__SORT_OVERSAMPLE;
+    sv_t *out = SBV_MALLOC(sizeof(*out) * count);
+    uint8_t *bucket_of = SBV_MALLOC(count);
+    sv_t *samples = SBV_MALLOC(sizeof(*samples) * samples_count);
+    sbv__sort_task_t *tasks = SBV_MALLOC(sizeof(*tasks) * threads);
+    if (out == NULL || bucket_of == NULL || samples == NULL || tasks == NULL){
+        SBV_FREE(out);
+        SBV_FREE(bucket_of);
+        SBV_FREE(samples);
+        SBV_FREE(tasks);
+        sbv__sort(svs, count, fold);
+        return;
+    }
+
+    // evenly spaced samples, their quantiles become the splitters
+    for (size_t i=0; i<samples_count; ++i){
+        samples[i] = svs[i * (count / samples_count)];
+    }
+    sbv__sort(samples, samples_count, fold);
+    for (size_t i=1; i<threads; ++i){
+        samples[i-1] = samples[i * SBV__SORT_OVERSAMPLE];
+    }
+
+    size_t chunk = (count + threads - 1) / threads;
+    for (size_t t=0; t<threads; ++t){
+        memset(&tasks[t], 0, sizeof(tasks[t]));
+        tasks[t].svs = svs;
+        tasks[t].out = out;
+        tasks[t].begin = SBV_MIN(t * chunk, count);
+        tasks[t].end = SBV_MIN(tasks[t].begin + chunk, count);
+        tasks[t].splitters = samples;
+        tasks[t].buckets = threads;
+        tasks[t].bucket_of = bucket_of;
+        tasks[t].fold = fold;
+    }
+    sbv__sort_run(tasks, threads, 0);
+
+    // each task scatters its views of bucket b behind the views of bucket b from earlier tasks
+    size_t offset = 0;
+    for (size_t b=0; b<threads; ++b){
+        tasks[b].sort_begin = offset;
+        for (size_t t=0; t<threads; ++t){
+            size_t n = tasks[t].counts[b];
+            tasks[t].counts[b] = offset;
+            offset += n;
+        }
+        tasks[b].sort_end = offset;
+    }
+    sbv__sort_run(tasks, threads, 1);
+    sbv__sort_run(tasks, threads, 2);
+
+    (void) memcpy(svs, out, sizeof(*svs) * count);
+    SBV_FREE(out);
+    SBV_FREE(bucket_of);
+    SBV_FREE(samples);
+    SBV_FREE(tasks);
+}
+
+SBVDEF void sv_sort_parallel(sv_t *svs, size_t count, size_t threads)
+{
+    sbv__sort_parallel(svs, count, threads, false);
+}
+
+SBVDEF void sv_sort_case_parallel(sv_t *svs, size_t count, size_t threads)
+{
+    sbv__sort_parallel(svs, count, threads, true);
+}
+#endif // SBV_THREADS
+
+SBVDEF size_t sv_dedup(sv_t *svs, size_t count)
+{
+    if (svs == NULL || count == 0) return 0;
+    size_t n = 1;
+    for (size_t i=1; i<count; ++i){
+        if (sv_compare(svs[n-1], svs[i]) != 0) svs[n++] = svs[i];
+    }
+    return n;
+}
+
+SBVDEF size_t sv_dedup_case(sv_t *svs, size_t count)
+{
+    if (svs == NULL || count == 0) return 0;
+    size_t n = 1;
+    for (size_t i=1; i<count; ++i){
+        if (sv_compare_case(svs[n-1], svs[i]) != 0) svs[n++] = svs[i];
+    }
+    return n;
+}
+
+#ifdef SBV_PROFILE
+#include <time.h>
+
+#define SBV__PROFILE_BUCKETS 48 // log2 buckets of ticks per call
+
+// only the owning thread writes a site, the reports read it concurrently, so every field is accessed atomically
+typedef struct {
+    SBV__ATOMIC(const char*) function;  // stored last, a site is in use once it is set
+    SBV__ATOMIC(const char*) file;
+    SBV__ATOMIC(int) line;
+    SBV__ATOMIC(uint64_t) calls;
+    SBV__ATOMIC(uint64_t) bytes;
+    SBV__ATOMIC(uint64_t) ticks;
+    SBV__ATOMIC(uint64_t) histogram[SBV__PROFILE_BUCKETS];
+} sbv__profile_site_t;
+
+// a merged copy of the sites of one call site
+typedef struct {
+    const char *function;
+    const char *file;
+    int line;
+    uint64_t calls;
+    uint64_t bytes;
+    uint64_t ticks;
+    uint64_t histogram[SBV__PROFILE_BUCKETS];
+} sbv__profile_stat_t;
+
+// every thread records into its own table, the tables are linked into a global list and merged by the reports
+// tables are never freed, the table of an exited thread is reused by the next thread that records a call
+typedef struct sbv__profile_table {
+    sbv__profile_site_t sites[SBV_PROFILE_SITES];
+    SBV__ATOMIC(uint64_t) dropped;     // calls not recorded because the table was full
+    SBV__ATOMIC(uint64_t) generation;  // the reset the content belongs to, older content counts as empty
+    SBV__ATOMIC(int) owned;            // a thread records into this table
+    struct sbv__profile_table *next;
+} sbv__profile_table_t;
+
+static SBV__ATOMIC(sbv__profile_table_t*) sbv__profile_tables;
+static SBV__ATOMIC(uint64_t) sbv__profile_generation;  // incremented by every reset
+static SBV__THREAD_LOCAL sbv__profile_table_t *sbv__profile_table;
+
+// the owner is the only writer, so a load and a store are enough to add to a field
+#define SBV__PROFILE_ADD(p, v) SBV__ATOMIC_STORE((p), SBV__ATOMIC_LOAD(p) + (v))
+
+#ifdef SBV_THREADS
+#include <pthread.h>
+
+// with SBV_THREADS a thread's table is released when the thread exits
+static pthread_key_t sbv__profile_key;
+static pthread_once_t sbv__profile_key_once = PTHREAD_ONCE_INIT;
+
+static inline void sbv__profile_exit(void *table)
+{
+    (void) table;
+    sbv_profile_release_thread();
+}
+
+static inline void sbv__profile_key_create(void)
+{
+    (void) pthread_key_create(&sbv__profile_key, sbv__profile_exit);
+}
+
+static inline void sbv__profile_register(sbv__profile_table_t *table)
+{
+    (void) pthread_once(&sbv__profile_key_once, sbv__profile_key_create);
+    (void) pthread_setspecific(sbv__profile_key, table);
+}
+#else
+static inline void sbv__profile_register(sbv__profile_table_t *table)
+{
+    (void) table;
+}
+#endif // SBV_THREADS
+
+// clear a table, only called by its owner
+static inline void sbv__profile_clear(sbv__profile_table_t *table)
+{
+    for (size_t i=0; i<SBV_PROFILE_SITES; ++i){
+        sbv__profile_site_t *site = &table->sites[i];
+        SBV__ATOMIC_STORE(&site->function, (const char*) NULL);
+        SBV__ATOMIC_STORE(&site->file, (const char*) NULL);
+        SBV__ATOMIC_STORE(&site->line, 0);
+        SBV__ATOMIC_STORE(&site->calls, (uint64_t) 0);
+        SBV__ATOMIC_STORE(&site->bytes, (uint64_t) 0);
+        SBV__ATOMIC_STORE(&site->ticks, (uint64_t) 0);
+        for (size_t b=0; b<SBV__PROFILE_BUCKETS; ++b) SBV__ATOMIC_STORE(&site->histogram[b], (uint64_t) 0);
+    }
+    SBV__ATOMIC_STORE(&table->dropped, (uint64_t) 0);
+}
+
+// take over the table of an exited thread, or link a new one into the list
+// return the table, or NULL on error
+static inline sbv__profile_table_t* sbv__profile_acquire(void)
+{
+    sbv__profile_table_t *table;
+    for (table = SBV__ATOMIC_LOAD(&sbv__profile_tables); table != NULL; table = table->next){
+        int expected = 0;
+        if (SBV__ATOMIC_LOAD(&table->owned) == 0 && SBV__ATOMIC_CAS(&table->owned, &expected, 1)) break;
+    }
+    if (table == NULL){
+        table = SBV_MALLOC(sizeof(*table));
+        if (table == NULL) return NULL;
+        memset(table, 0, sizeof(*table));
+        SBV__ATOMIC_STORE(&table->owned, 1);
+        SBV__ATOMIC_STORE(&table->generation, SBV__ATOMIC_LOAD(&sbv__profile_generation));
+        table->next = SBV__ATOMIC_LOAD(&sbv__profile_tables);
+        while (!SBV__ATOMIC_CAS(&sbv__profile_tables, &table->next, table));
+    }
+    sbv__profile_register(table);
+    return table;
+}
+
+SBVDEF uint64_t sbv_profile_ticks(void)
+{
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    uint32_t lo, hi;
+    __asm__ __volatile__ ("rdtsc" : "=a"(lo), "=d"(hi));
+    return (uint64_t) hi << 32 | lo;
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+    uint64_t ticks;
+    __asm__ __volatile__ ("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#elif defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+#else
+    return (uint64_t) clock();
+#endif
+}
+
+SBVDEF void sbv_profile_record(const char *function, const char *file, int line, size_t bytes, uint64_t ticks)
+{
+    sbv__profile_table_t *table = sbv__profile_table;
+    if (table == NULL){
+        table = sbv__profile_acquire();
+        if (table == NULL) return;
+        sbv__profile_table = table;
+    }
+    // a reset only bumps the generation, the owner clears its table on its next call
+    uint64_t generation = SBV__ATOMIC_LOAD(&sbv__profile_generation);
+    if (SBV__ATOMIC_LOAD(&table->generation) != generation){
+        sbv__profile_clear(table);
+        SBV__ATOMIC_STORE(&table->generation, generation);
+    }
+
+    uintptr_t hash = ((uintptr_t) function ^ ((uintptr_t) file >> 3) ^ ((uintptr_t) line * 0x9E3779B1u));
+    hash ^= hash >> 15;
+    for (size_t probe=0; probe<SBV_PROFILE_SITES; ++probe){
+        sbv__profile_site_t *site = &table->sites[(hash + probe) & (SBV_PROFILE_SITES - 1)];
+        const char *site_function = SBV__ATOMIC_LOAD(&site->function);
+        if (site_function == NULL){
+            SBV__ATOMIC_STORE(&site->file, file);
+            SBV__ATOMIC_STORE(&site->line, line);
+            SBV__ATOMIC_STORE(&site->function, function);
+        } else if (site_function != function || SBV__ATOMIC_LOAD(&site->file) != file || SBV__ATOMIC_LOAD(&site->line) != line){
+            continue;
+        }
+        size_t bucket = 0;
+        while (bucket + 1 < SBV__PROFILE_BUCKETS && (ticks >> (bucket + 1)) != 0) bucket += 1;
+        SBV__PROFILE_ADD(&site->calls, 1);
+        SBV__PROFILE_ADD(&site->bytes, bytes);
+        SBV__PROFILE_ADD(&site->ticks, ticks);
+        SBV__PROFILE_ADD(&site->histogram[bucket], 1);
+        return;
+    }
+    SBV__PROFILE_ADD(&table->dropped, 1);
+}
+
+SBVDEF void sbv_profile_reset(void)
+{
+    SBV__ATOMIC_FETCH_ADD(&sbv__profile_generation, (uint64_t) 1);
+}
+
+SBVDEF void sbv_profile_release_thread(void)
+{
+    sbv__profile_table_t *table = sbv__profile_table;
+    if (table == NULL) return;
+    sbv__profile_table = NULL;
+    SBV__ATOMIC_STORE(&table->owned, 0);
+}
+
+static inline int sbv__profile_site_compare(const void *a, const void *b)
+{
+    const sbv__profile_stat_t *sa = a, *sb = b;
+    int result = strcmp(sa->function, sb->function);
+    if (result == 0) result = strcmp(sa->file, sb->file);
+    if (result == 0) result = (sa->line > sb->line) - (sa->line < sb->line);
+    return result;
+}
+
+static inline int sbv__profile_site_compare_ticks(const void *a, const void *b)
+{
+    const sbv__profile_stat_t *sa = a, *sb = b;
+    return (sa->ticks < sb->ticks) - (sa->ticks > sb->ticks);
+}
+
+// collect the sites of all threads, merge equal call sites and sort them by total ticks
+// return the merged sites, which have to be freed with SBV_FREE
+static inline sbv__profile_stat_t* sbv__profile_merge(size_t *count, uint64_t *dropped)
+{
+    // tables are only ever added at the head, so both passes see the same tables
+    sbv__profile_table_t *head = SBV__ATOMIC_LOAD(&sbv__profile_tables);
+    size_t n = 0;
+    *dropped = 0;
+    for (sbv__profile_table_t *table = head; table != NULL; table = table->next){
+        n += SBV_PROFILE_SITES;
+    }
+    sbv__profile_stat_t *sites = SBV_MALLOC(sizeof(*sites) * (n ? n : 1));
+    if (sites == NULL) return NULL;
+
+    n = 0;
+    uint64_t generation = SBV__ATOMIC_LOAD(&sbv__profile_generation);
+    for (sbv__profile_table_t *table = head; table != NULL; table = table->next){
+        if (SBV__ATOMIC_LOAD(&table->generation) != generation) continue;
+        for (size_t i=0; i<SBV_PROFILE_SITES; ++i){
+            const sbv__profile_site_t *site = &table->sites[i];
+            sbv__profile_stat_t *stat = &sites[n];
+            stat->function = SBV__ATOMIC_LOAD(&site->function);
+            if (stat->function == NULL) continue;
+            stat->file = SBV__ATOMIC_LOAD(&site->file);
+            stat->line = SBV__ATOMIC_LOAD(&site->line);
+            stat->calls = SBV__ATOMIC_LOAD(&site->calls);
+            stat->bytes = SBV__ATOMIC_LOAD(&site->bytes);
+            stat->ticks = SBV__ATOMIC_LOAD(&site->ticks);
+            for (size_t b=0; b<SBV__PROFILE_BUCKETS; ++b) stat->histogram[b] = SBV__ATOMIC_LOAD(&site->histogram[b]);
+            // the owner may be clearing the site right now
+            if (stat->file == NULL || stat->calls == 0) continue;
+            n += 1;
+        }
+        *dropped += SBV__ATOMIC_LOAD(&table->dropped);
+    }
+    qsort(sites, n, sizeof(*sites), sbv__profile_site_compare);
+
+    size_t merged = 0;
+    for (size_t i=0; i<n; ++i){
+        if (merged > 0 && sbv__profile_site_compare(&sites[merged-1], &sites[i]) == 0){
+            sbv__profile_stat_t *site = &sites[merged-1];
+            site->calls += sites[i].calls;
+            site->bytes += sites[i].bytes;
+            site->ticks += sites[i].ticks;
+            for (size_t b=0; b<SBV__PROFILE_BUCKETS; ++b) site->histogram[b] += sites[i].histogram[b];
+        } else{
+            sites[merged++] = sites[i];
+        }
+    }
+    qsort(sites, merged, sizeof(*sites), sbv__profile_site_compare_ticks);
+    *count = merged;
+    return sites;
+}
+
+// upper bound of the histogram bucket holding the given fraction of calls
+static inline uint64_t sbv__profile_percentile(const sbv__profile_stat_t *site, double fraction)
+{
+    uint64_t target = (uint64_t)((double) site->calls * fraction);
+    uint64_t seen = 0;
+    for (size_t b=0; b<SBV__PROFILE_BUCKETS; ++b){
+        seen += site->histogram[b];
+        if (seen > target) return (uint64_t) 2 << b;
+    }
+    return (uint64_t) 2 << (SBV__PROFILE_BUCKETS - 1);
+}
+
+SBVDEF void sbv_profile_report(FILE *f)
+{
+    if (f == NULL) return;
+    size_t count;
+    uint64_t dropped;
+    sbv__profile_stat_t *sites = sbv__profile_merge(&count, &dropped);
+    if (sites == NULL) return;
+
+    fprintf(f, "%-24s %-32s %12s %14s %16s %10s %10s %10s\n",
+            "function", "call site", "calls", "bytes", "ticks", "avg", "p50 <=", "p99 <=");
+    for (size_t i=0; i<count; ++i){
+        const sbv__profile_stat_t *site = &sites[i];
+        char location[256];
+        (void) snprintf(location, sizeof(location), "%s:%d", site->file, site->line);
+        fprintf(f, "%-24s %-32s %12llu %14llu %16llu %10llu %10llu %10llu\n",
+                site->function, location,
+                (unsigned long long) site->calls, (unsigned long long) site->bytes,
+                (unsigned long long) site->ticks, (unsigned long long)(site->ticks / site->calls),
+                (unsigned long long) sbv__profile_percentile(site, 0.5),
+                (unsigned long long) sbv__profile_percentile(site, 0.99));
+    }
+    if (dropped > 0) fprintf(f, "%llu calls dropped, increase SBV_PROFILE_SITES\n", (unsigned long long) dropped);
+    SBV_FREE(sites);
+}
+
+SBVDEF void sbv_profile_report_json(FILE *f)
+{
+    if (f == NULL) return;
+    size_t count;
+    uint64_t dropped;
+    sbv__profile_stat_t *sites = sbv__profile_merge(&count, &dropped);
+    if (sites == NULL) return;
+
+    sb_t sb = sb_null();
+    sb_appendf(&sb, "{\"dropped\":%llu,\"sites\":[", (unsigned long long) dropped);
+    for (size_t i=0; i<count; ++i){
+        const sbv__profile_stat_t *site = &sites[i];
+        sb_append_cstr(&sb, i ? ",{\"function\":\"" : "{\"function\":\"");
+        sb_append_json_escaped(&sb, sv_from_cstr(site->function));
+        sb_append_cstr(&sb, "\",\"file\":\"");
+        sb_append_json_escaped(&sb, sv_from_cstr(site->file));
+        sb_appendf(&sb, "\",\"line\":%d,\"calls\":%llu,\"bytes\":%llu,\"ticks\":%llu,\"histogram\":[",
+                   site->line, (unsigned long long) site->calls,
+                   (unsigned long long) site->bytes, (unsigned long long) site->ticks);
+        size_t last = SBV__PROFILE_BUCKETS;
+        while (last > 0 && site->histogram[last-1] == 0) last -= 1;
+        for (size_t b=0; b<last; ++b){
+            sb_appendf(&sb, b ? ",%llu" : "%llu", (unsigned long long) site->histogram[b]);
+        }
+        sb_append_cstr(&sb, "]}");
+    }
+    sb_append_cstr(&sb, "]}\n");
+    (void) fwrite(sb.items, 1, sb.count, f);
+    sb_free(&sb);
+    SBV_FREE(sites);
+}
+#endif // SBV_PROFILE
+
+typedef struct {
+    uint64_t set[4];   // bytes matched by this element
+    int literal;       // the byte if it is a single literal, else -1
+    bool star;         // a `*` precedes this element
+} sbv__glob_element_t;
+
+static inline void sbv__glob_set(uint64_t set[4], unsigned char c)
+{
+    set[c >> 6] |= (uint64_t)1 << (c & 63);
+}
+
+static inline bool sbv__glob_has(const uint64_t set[4], unsigned char c)
+{
+    return (set[c >> 6] >> (c & 63)) & 1;
+}
+
+static inline void sbv__glob_fold(uint64_t set[4])
+{
+    for (unsigned char u='A'; u<='Z'; ++u){
+        unsigned char l = u + ('a' - 'A');
+        if (sbv__glob_has(set, u) || sbv__glob_has(set, l)){
+            sbv__glob_set(set, u);
+            sbv__glob_set(set, l);
+        }
+    }
+}
+
+// parse a bracket expression starting after the `[`
+// return the index after the closing `]`, or 0 if it is not terminated, `out` is only written on success
+static inline size_t sbv__glob_class(sv_t pattern, size_t i, uint64_t out[4], bool fold)
+{
+    uint64_t set[4] = {0};
+    bool negate = i < pattern.len && (pattern.items[i] == '!' || pattern.items[i] == '^');
+    if (negate) i += 1;
+    size_t first = i;
+    while (i < pattern.len && (pattern.items[i] != ']' || i == first)){
+        unsigned char lo = (unsigned char) pattern.items[i++];
+        if (lo == '\\' && i < pattern.len) lo = (unsigned char) pattern.items[i++];
+        unsigned char hi = lo;
+        if (i + 1 < pattern.len && pattern.items[i] == '-' && pattern.items[i+1] != ']'){
+            hi = (unsigned char) pattern.items[i+1];
+            i += 2;
+            if (hi == '\\' && i < pattern.len) hi = (unsigned char) pattern.items[i++];
+        }
+        for (unsigned c = lo; c <= hi; ++c) sbv__glob_set(set, (unsigned char) c);
+    }
+    if (i >= pattern.len) return 0;
+    if (fold) sbv__glob_fold(set);
+    if (negate){
+        for (size_t w=0; w<4; ++w) set[w] = ~set[w];
+    }
+    memcpy(out, set, sizeof(set));
+    return i + 1;
+}
+
+SBVDEF bool sv_glob_compile(sv_glob_t *glob, sv_t pattern, int flags)
+{
+    if (glob == NULL || (pattern.items == NULL && pattern.len > 0)) return false;
+    memset(glob, 0, sizeof(*glob));
+    glob->flags = flags;
+
+    sbv__glob_element_t *elements = SBV_MALLOC(sizeof(*elements) * (pattern.len + 1));
+    if (elements == NULL) return false;
+
+    size_t n = 0;
+    bool star = false;
+    for (size_t i=0; i<pattern.len;){
+        char c = pattern.items[i++];
+        if (c == '*'){
+            star = true;
+            continue;
+        }
+        sbv__glob_element_t *e = &elements[n++];
+        memset(e, 0, sizeof(*e));
+        e->star = star;
+        e->literal = -1;
+        star = false;
+
+        size_t end;
+        if (c == '?'){
+            for (size_t w=0; w<4; ++w) e->set[w] = ~(uint64_t)0;
+        } else if (c == '[' && (end = sbv__glob_class(pattern, i, e->set, flags & SV_GLOB_CASE)) != 0){
+            i = end;
+        } else{
+            if (c == '\\' && i < pattern.len) c = pattern.items[i++];
+            e->literal = (unsigned char) c;
+            sbv__glob_set(e->set, (unsigned char) c);
+            if (flags & SV_GLOB_CASE) sbv__glob_fold(e->set);
+        }
+        if (e->literal < 0 && (flags & SV_GLOB_PATHNAME)) e->set['/' >> 6] &= ~((uint64_t)1 << ('/' & 63));
+    }
+    glob->has_star = star;
+    for (size_t i=0; i<n; ++i) glob->has_star |= elements[i].star;
+    glob->states = n;
+    glob->words = (n + 1 + 63) / 64;
+
+    glob->masks = SBV_MALLOC(sizeof(uint64_t) * glob->words * 257);
+    glob->literals = SBV_MALLOC(n + 1);
+    if (glob->masks == NULL || glob->literals == NULL){
+        SBV_FREE(elements);
+        sv_glob_free(glob);
+        return false;
+    }
+    glob->loops = glob->masks + glob->words * 256;
+    memset(glob->masks, 0, sizeof(uint64_t) * glob->words * 257);
+    for (size_t i=0; i<n; ++i){
+        size_t bit = i + 1;
+        for (unsigned c=0; c<256; ++c){
+            if (sbv__glob_has(elements[i].set, (unsigned char) c)){
+                glob->masks[c * glob->words + bit / 64] |= (uint64_t)1 << (bit % 64);
+            }
+        }
+        if (elements[i].star) glob->loops[i / 64] |= (uint64_t)1 << (i % 64);
+    }
+    if (star) glob->loops[n / 64] |= (uint64_t)1 << (n % 64);
+
+    // literal prefix, suffix and the longest literal run in between, used to reject most inputs without running the NFA
+    size_t used = 0;
+    size_t prefix = 0;
+    while (prefix < n && elements[prefix].literal >= 0 && !elements[prefix].star){
+        glob->literals[used++] = (char) elements[prefix++].literal;
+    }
+    glob->prefix = sv_from_slice(glob->literals, prefix);
+    glob->start = prefix;
+
+    // the elements after the last `*` match a fixed number of bytes at the end
+    size_t suffix = n;
+    if (glob->has_star && !star){
+        while (suffix > prefix && elements[suffix-1].literal >= 0){
+            suffix -= 1;
+            if (elements[suffix].star) break;
+        }
+        for (size_t i=suffix; i<n; ++i) glob->literals[used++] = (char) elements[i].literal;
+        glob->suffix = sv_from_slice(glob->literals + prefix, n - suffix);
+    }
+
+    size_t best = 0, best_len = 0;
+    for (size_t i=prefix; i<suffix;){
+        if (elements[i].literal < 0){
+            i += 1;
+            continue;
+        }
+        size_t j = i + 1;
+        while (j < suffix && elements[j].literal >= 0 && !elements[j].star) j += 1;
+        if (j - i > best_len){
+            best = i;
+            best_len = j - i;
+        }
+        i = j;
+    }
+    if (best_len >= 2){
+        for (size_t i=best; i<best+best_len; ++i) glob->literals[used++] = (char) elements[i].literal;
+        glob->required = sv_from_slice(glob->literals + used - best_len, best_len);
+    }
+
+    SBV_FREE(elements);
+    return true;
+}
+
+SBVDEF bool sv_glob_match(const sv_glob_t *glob, sv_t sv)
+{
+    if (glob == NULL || glob->masks == NULL) return false;
+    if (sv.len < glob->states) return false;
+    if (!glob->has_star && sv.len != glob->states) return false;
+
+    bool fold = glob->flags & SV_GLOB_CASE;
+    if (!(fold ? sv_starts_with_case(sv, glob->prefix) : sv_starts_with(sv, glob->prefix))) return false;
+    if (glob->start == glob->states && !glob->has_star) return true;
+    if (!(fold ? sv_ends_with_case(sv, glob->suffix) : sv_ends_with(sv, glob->suffix))) return false;
+    if (glob->required.len > 0){
+        sv_t middle = sv_slice(sv, glob->prefix.len, sv.len - glob->suffix.len);
+        if ((fold ? sv_find_case(middle, glob->required) : sv_find(middle, glob->required)) == SIZE_MAX) return false;
+    }
+
+    bool pathname = glob->flags & SV_GLOB_PATHNAME;
+    size_t accept = glob->states;
+    const unsigned char *p = (const unsigned char*) sv.items;
+
+    if (glob->words == 1){
+        uint64_t state = (uint64_t)1 << glob->start;
+        uint64_t loops = glob->loops[0];
+        for (size_t i=glob->prefix.len; i<sv.len && state != 0; ++i){
+            uint64_t stay = (pathname && p[i] == '/') ? 0 : state & loops;
+            state = ((state << 1) & glob->masks[p[i]]) | stay;
+        }
+        return (state >> accept) & 1;
+    }
+
+    // the state vector of long patterns spans multiple words, which are shifted with a carry
+    uint64_t small[4];
+    uint64_t *state = glob->words <= 4 ? small : SBV_MALLOC(sizeof(uint64_t) * glob->words);
+    if (state == NULL) return false;
+    memset(state, 0, sizeof(uint64_t) * glob->words);
+    state[glob->start / 64] = (uint64_t)1 << (glob->start % 64);
+
+    bool alive = true;
+    for (size_t i=glob->prefix.len; i<sv.len && alive; ++i){
+        const uint64_t *mask = &glob->masks[p[i] * glob->words];
+        bool loop = !(pathname && p[i] == '/');
+        uint64_t carry = 0;
+        alive = false;
+        for (size_t w=0; w<glob->words; ++w){
+            uint64_t stay = loop ? state[w] & glob->loops[w] : 0;
+            uint64_t next = ((state[w] << 1) | carry) & mask[w];
+            carry = state[w] >> 63;
+            state[w] = next | stay;
+            alive |= state[w] != 0;
+        }
+    }
+    bool matched = (state[accept / 64] >> (accept % 64)) & 1;
+    if (state != small) SBV_FREE(state);
+    return matched;
+}
+
+SBVDEF size_t sv_glob_match_many(const sv_glob_t *globs, size_t count, sv_t sv, bool *matches)
+{
+    if (globs == NULL) return 0;
+    size_t matched = 0;
+    for (size_t i=0; i<count; ++i){
+        bool match = sv_glob_match(&globs[i], sv);
+        if (matches) matches[i] = match;
+        matched += match;
+    }
+    return matched;
+}
+
+SBVDEF void sv_glob_free(sv_glob_t *glob)
+{
+    if (glob == NULL) return;
+    SBV_FREE(glob->masks);
+    SBV_FREE(glob->literals);
+    memset(glob, 0, sizeof(*glob));
+}
+
+// Myers' bit-parallel edit distance, blocked into 64-row words for longer patterns (Hyyrö's formulation)
+// bit i of the vertical delta vectors `pv`/`mv` is set if D[i+1][j] - D[i][j] is +1/-1
+#define SBV__MYERS_STACK_BLOCKS 4 // patterns up to 256 bytes are handled without heap allocation
+
+typedef struct {
+    uint64_t *peq;    // 256 * blocks, bit i of peq[c * blocks + i / 64] is set if pattern[i] == c
+    uint64_t *pv;
+    uint64_t *mv;
+    size_t blocks;
+    uint64_t high;    // bit of the last pattern row in the last block
+    uint64_t *heap;
+    uint64_t stack[SBV__MYERS_STACK_BLOCKS * 258];
+} sbv__myers_t;
+
+static inline bool sbv__myers_init(sbv__myers_t *my, sv_t pattern, bool reverse)
+{
+    my->blocks = (pattern.len + 63) / 64;
+    my->high = (uint64_t)1 << ((pattern.len - 1) % 64);
+    size_t words = my->blocks * 258;
+    my->heap = NULL;
+    uint64_t *storage = my->stack;
+    if (my->blocks > SBV__MYERS_STACK_BLOCKS){
+        my->heap = SBV_MALLOC(sizeof(uint64_t) * words);
+        if (my->heap == NULL) return false;
+        storage = my->heap;
+    }
+    memset(storage, 0, sizeof(uint64_t) * words);
+    my->peq = storage;
+    my->pv = storage + 256 * my->blocks;
+    my->mv = my->pv + my->blocks;
+    for (size_t i=0; i<pattern.len; ++i){
+        unsigned char c = (unsigned char) pattern.items[reverse ? pattern.len - 1 - i : i];
+        my->peq[c * my->blocks + i / 64] |= (uint64_t)1 << (i % 64);
+    }
+    for (size_t b=0; b<my->blocks; ++b) my->pv[b] = ~(uint64_t)0;
+    return true;
+}
+
+// advance by one text byte, `hin` is the horizontal delta entering the first row (1 for global alignment, 0 for search)
+// return the horizontal delta leaving the last row
+static inline int sbv__myers_step(sbv__myers_t *my, unsigned char c, int hin)
+{
+    const uint64_t *peq = &my->peq[c * my->blocks];
+    for (size_t b=0; b<my->blocks; ++b){
+        uint64_t pv = my->pv[b], mv = my->mv[b];
+        uint64_t eq = peq[b];
+        uint64_t xv = eq | mv;
+        if (hin < 0) eq |= 1;
+        uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        uint64_t ph = mv | ~(xh | pv);
+        uint64_t mh = pv & xh;
+        uint64_t high = (b + 1 == my->blocks) ? my->high : (uint64_t)1 << 63;
+        int hout = (ph & high) ? 1 : (mh & high) ? -1 : 0;
+        ph <<= 1;
+        mh <<= 1;
+        if (hin < 0) mh |= 1;
+        else if (hin > 0) ph |= 1;
+        my->pv[b] = mh | ~(xv | ph);
+        my->mv[b] = ph & xv;
+        hin = hout;
+    }
+    return hin;
+}
+
+static inline void sbv__myers_free(sbv__myers_t *my)
+{
+    SBV_FREE(my->heap);
+}
+
+SBVDEF size_t sv_edit_distance(sv_t a, sv_t b)
+{
+    return sv_edit_distance_bounded(a, b, SIZE_MAX - 1);
+}
+
+SBVDEF size_t sv_edit_distance_bounded(sv_t a, sv_t b, size_t max_distance)
+{
+    // common prefixes and suffixes never contribute to the distance
+    while (a.len > 0 && b.len > 0 && a.items[0] == b.items[0]){
+        a = sv_chop_left(a, 1);
+        b = sv_chop_left(b, 1);
+    }
+    while (a.len > 0 && b.len > 0 && a.items[a.len-1] == b.items[b.len-1]){
+        a = sv_chop_right(a, 1);
+        b = sv_chop_right(b, 1);
+    }
+    // the shorter string is the pattern, so it spans as few blocks as possible
+    if (a.len > b.len){
+        sv_t t = a;
+        a = b;
+        b = t;
+    }
+    if (b.len - a.len > max_distance) return SIZE_MAX;
+    if (a.len == 0) return b.len;
+
+    sbv__myers_t my;
+    if (!sbv__myers_init(&my, a, false)) return SIZE_MAX;
+    size_t score = a.len;
+    for (size_t j=0; j<b.len; ++j){
+        score += sbv__myers_step(&my, (unsigned char) b.items[j], 1);
+        // every remaining text byte can lower the distance by at most one
+        if (score > max_distance && score - max_distance > b.len - j - 1){
+            score = SIZE_MAX;
+            break;
+        }
+    }
+    sbv__myers_free(&my);
+    return score;
+}
+
+SBVDEF size_t sv_find_approx(sv_t sv, sv_t query, size_t max_distance, size_t *match_len)
+{
+    if (sv.items == NULL) return SIZE_MAX;
+    if (query.len <= max_distance){
+        if (match_len) *match_len = 0;
+        return 0;
+    }
+
+    // search for the first end position of a match, then follow it while the distance keeps dropping
+    sbv__myers_t my;
+    if (!sbv__myers_init(&my, query, false)) return SIZE_MAX;
+    size_t score = query.len;
+    size_t end = SIZE_MAX;
+    for (size_t j=0; j<sv.len; ++j){
+        size_t next = score + sbv__myers_step(&my, (unsigned char) sv.items[j], 0);
+        if (end != SIZE_MAX && next >= score) break;
+        score = next;
+        if (score <= max_distance) end = j + 1;
+    }
+    sbv__myers_free(&my);
+    if (end == SIZE_MAX) return SIZE_MAX;
+
+    // align the reversed query globally against the text before `end` to find the best start, preferring longer matches
+    if (!sbv__myers_init(&my, query, true)) return SIZE_MAX;
+    size_t best = score;
+    size_t best_len = SIZE_MAX;
+    size_t limit = SBV_MIN(end, query.len + max_distance);
+    size_t distance = query.len;
+    for (size_t t=1; t<=limit; ++t){
+        distance += sbv__myers_step(&my, (unsigned char) sv.items[end - t], 1);
+        if (distance <= best){
+            best = distance;
+            best_len = t;
+        }
+    }
+    sbv__myers_free(&my);
+    if (best_len == SIZE_MAX) best_len = 0;
+    if (match_len) *match_len = best_len;
+    return end - best_len;
+}
+
+SBVDEF bool sb_template_compile(sb_template_t *tpl, sv_t format, size_t *error_offset)
+{
+    if (tpl == NULL || (format.items == NULL && format.len > 0)) return false;
+    memset(tpl, 0, sizeof(*tpl));
+
+    // names are views into the literal storage, which is sized for the whole format
+    size_t max_parts = format.len / 2 + 1;
+    tpl->literals = SBV_MALLOC(format.len + 1);
+    tpl->parts = SBV_MALLOC(sizeof(*tpl->parts) * max_parts);
+    tpl->names = SBV_MALLOC(sizeof(*tpl->names) * max_parts);
+    tpl->types = SBV_MALLOC(sizeof(*tpl->types) * max_parts);
+    if (tpl->literals == NULL || tpl->parts == NULL || tpl->names == NULL || tpl->types == NULL){
+        sb_template_free(tpl);
+        return false;
+    }
+
+    char *names = tpl->literals + format.len; // names are stored from the end of the storage backwards
+    size_t used = 0;
+    size_t start = 0;
+    size_t i = 0;
+    while (i < format.len){
+        char c = format.items[i];
+        if ((c == '{' || c == '}') && i + 1 < format.len && format.items[i+1] == c){
+            tpl->literals[used++] = c;
+            i += 2;
+            continue;
+        }
+        if (c == '}') goto error;
+        if (c != '{'){
+            tpl->literals[used++] = c;
+            i += 1;
+            continue;
+        }
+
+        const char *close = memchr(format.items + i, '}', format.len - i);
+        if (close == NULL) goto error;
+        sv_t spec = sv_from_slice(format.items + i + 1, (size_t)(close - format.items) - i - 1);
+        sv_t type_spec;
+        sv_t name = sv_split_char(spec, ':', &type_spec);
+        sb_template_type_t type = SB_TEMPLATE_SV;
+        if (!sv_isnull(type_spec)){
+            if (type_spec.len != 1) goto error;
+            switch (type_spec.items[0]){
+                case 'v': type = SB_TEMPLATE_SV;     break;
+                case 's': type = SB_TEMPLATE_CSTR;   break;
+                case 'd': type = SB_TEMPLATE_INT;    break;
+                case 'u': type = SB_TEMPLATE_UINT;   break;
+                case 'x': type = SB_TEMPLATE_HEX;    break;
+                case 'c': type = SB_TEMPLATE_CHAR;   break;
+                case 'f': type = SB_TEMPLATE_DOUBLE; break;
+                default: goto error;
+            }
+        }
+        if (sv_contains_char(name, '{')) goto error;
+
+        size_t arg = name.len > 0 ? sb_template_arg_index(tpl, name) : SIZE_MAX;
+        if (arg != SIZE_MAX && tpl->types[arg] != type) goto error;
+        if (arg == SIZE_MAX){
+            arg = tpl->args_count++;
+            names -= name.len;
+            (void) memcpy(names, name.items, name.len);
+            tpl->names[arg] = sv_from_slice(names, name.len);
+            tpl->types[arg] = type;
+        }
+        tpl->parts[tpl->parts_count++] = (sb_template_part_t){
+            .offset = start,
+            .len = used - start,
+            .arg = arg
+        };
+        start = used;
+        i = (size_t)(close - format.items) + 1;
+    }
+    tpl->parts[tpl->parts_count++] = (sb_template_part_t){
+        .offset = start,
+        .len = used - start,
+        .arg = SIZE_MAX
+    };
+    tpl->literals_len = used;
+    return true;
+
+error:
+    if (error_offset) *error_offset = i;
+    sb_template_free(tpl);
+    return false;
+}
+
+SBVDEF size_t sb_template_arg_index(const sb_template_t *tpl, sv_t name)
+{
+    if (tpl == NULL || name.len == 0) return SIZE_MAX;
+    for (size_t i=0; i<tpl->args_count; ++i){
+        if (sv_equals(tpl->names[i], name)) return i;
+    }
+    return SIZE_MAX;
+}
+
+static const char sbv__digit_pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// write the decimal digits of a number
+// return the number of bytes written, at most 20
+static inline size_t sbv__write_uint(char *out, uint64_t value)
+{
+    char buffer[20];
+    char *p = buffer + sizeof(buffer);
+    while (value >= 100){
+        const char *pair = &sbv__digit_pairs[(value % 100) * 2];
+        value /= 100;
+        *--p = pair[1];
+        *--p = pair[0];
+    }
+    if (value >= 10){
+        *--p = sbv__digit_pairs[value * 2 + 1];
+        *--p = sbv__digit_pairs[value * 2];
+    } else{
+        *--p = (char)('0' + value);
+    }
+    size_t n = (size_t)(buffer + sizeof(buffer) - p);
+    (void) memcpy(out, p, n);
+    return n;
+}
+
+static inline size_t sbv__write_hex(char *out, uint64_t value)
+{
+    size_t digits = 1;
+    while (digits < 16 && (value >> (4 * digits)) != 0) digits += 1;
+    for (size_t i=0; i<digits; ++i){
+        out[digits - 1 - i] = "0123456789abcdef"[(value >> (4 * i)) & 0xF];
+    }
+    return digits;
+}
+
+#define SBV__TEMPLATE_DOUBLE_MAX 32 // "%g" never takes more than this
+
+SBVDEF int sb_template_render(sb_t *sb, const sb_template_t *tpl, const sb_template_arg_t *args, size_t count)
+{
+    if (sb == NULL || tpl == NULL || tpl->parts == NULL) return -1;
+    if (count < tpl->args_count || (args == NULL && tpl->args_count > 0)) return -1;
+
+    // size the output once, numbers are counted with their maximum width
+    size_t total = tpl->literals_len;
+    for (size_t i=0; i<tpl->parts_count; ++i){
+        size_t arg = tpl->parts[i].arg;
+        if (arg == SIZE_MAX) continue;
+        size_t n = 0;
+        switch (tpl->types[arg]){
+            case SB_TEMPLATE_SV:     n = args[arg].sv.len; break;
+            case SB_TEMPLATE_CSTR:   n = args[arg].cstr ? strlen(args[arg].cstr) : 0; break;
+            case SB_TEMPLATE_INT:    n = 20; break;
+            case SB_TEMPLATE_UINT:   n = 20; break;
+            case SB_TEMPLATE_HEX:    n = 16; break;
+            case SB_TEMPLATE_CHAR:   n = 1; break;
+            case SB_TEMPLATE_DOUBLE: n = SBV__TEMPLATE_DOUBLE_MAX; break;
+        }
+        if (n > SIZE_MAX - total) return -1;
+        total += n;
+    }
+    if (total > INT_MAX || !sb_reserve(sb, total)) return -1;
+
+    char *out = sb->items + sb->count;
+    for (size_t i=0; i<tpl->parts_count; ++i){
+        const sb_template_part_t *part = &tpl->parts[i];
+        (void) memcpy(out, tpl->literals + part->offset, part->len);
+        out += part->len;
+        if (part->arg == SIZE_MAX) continue;
+
+        const sb_template_arg_t *arg = &args[part->arg];
+        switch (tpl->types[part->arg]){
+            case SB_TEMPLATE_SV:
+                if (arg->sv.len > 0) (void) memcpy(out, arg->sv.items, arg->sv.len);
+                out += arg->sv.len;
+                break;
+            case SB_TEMPLATE_CSTR:
+                if (arg->cstr){
+                    size_t n = strlen(arg->cstr);
+                    (void) memcpy(out, arg->cstr, n);
+                    out += n;
+                }
+                break;
+            case SB_TEMPLATE_INT:
+                if (arg->i < 0){
+                    *out++ = '-';
+                    out += sbv__write_uint(out, (uint64_t) 0 - (uint64_t) arg->i);
+                } else{
+                    out += sbv__write_uint(out, (uint64_t) arg->i);
+                }
+                break;
+            case SB_TEMPLATE_UINT:
+                out += sbv__write_uint(out, arg->u);
+                break;
+            case SB_TEMPLATE_HEX:
+                out += sbv__write_hex(out, arg->u);
+                break;
+            case SB_TEMPLATE_CHAR:
+                *out++ = arg->c;
+                break;
+            case SB_TEMPLATE_DOUBLE: {
+                int n = snprintf(out, SBV__TEMPLATE_DOUBLE_MAX, "%g", arg->f);
+                if (n > 0) out += SBV_MIN((size_t) n, (size_t) SBV__TEMPLATE_DOUBLE_MAX - 1);
+            } break;
+        }
+    }
+    size_t n = (size_t)(out - (sb->items + sb->count));
+    sb->count += n;
+    return (int) n;
+}
+
+SBVDEF void sb_template_free(sb_template_t *tpl)
+{
+    if (tpl == NULL) return;
+    SBV_FREE(tpl->literals);
+    SBV_FREE(tpl->parts);
+    SBV_FREE(tpl->names);
+    SBV_FREE(tpl->types);
+    memset(tpl, 0, sizeof(*tpl));
+}
+
+// make room for at least n more line starts
+static inline bool sbv__lines_grow(sv_lines_t *lines, size_t n)
+{
+    if (lines->count + n <= lines->capacity) return true;
+    size_t new_capacity = lines->capacity ? lines->capacity : 64;
+    while (new_capacity < lines->count + n) new_capacity *= 2;
+    size_t *new_starts = SBV_REALLOC(lines->starts, sizeof(*new_starts) * new_capacity);
+    if (new_starts == NULL) return false;
+    lines->starts = new_starts;
+    lines->capacity = new_capacity;
+    return true;
+}
+
+SBVDEF bool sv_lines_build(sv_lines_t *lines, sv_t sv)
+{
+    if (lines == NULL) return false;
+    lines->count = 0;
+    lines->len = 0;
+    if (!sbv__lines_grow(lines, 1)) return false;
+    lines->starts[lines->count++] = 0;
+    return sv_lines_extend(lines, sv);
+}
+
+SBVDEF bool sv_lines_extend(sv_lines_t *lines, sv_t sv)
+{
+    if (lines == NULL || lines->count == 0 || sv.len < lines->len) return false;
+    if (sv.items == NULL) return sv.len == 0;
+
+    size_t i = lines->len;
+    // most words have no newline, those with one record at most 8 starts
+    for (; i + 8 <= sv.len; i += 8){
+        uint64_t v = sbv__load64(sv.items + i);
+        if (!SBV__HAS_BYTE(v, '\n')) continue;
+        if (!sbv__lines_grow(lines, 8)) goto error;
+        for (size_t j=i; j<i+8; ++j){
+            if (sv.items[j] == '\n') lines->starts[lines->count++] = j + 1;
+        }
+    }
+    for (; i < sv.len; ++i){
+        if (sv.items[i] != '\n') continue;
+        if (!sbv__lines_grow(lines, 1)) goto error;
+        lines->starts[lines->count++] = i + 1;
+    }
+    lines->len = sv.len;
+    return true;
+
+error:
+    lines->len = i; // keep the index consistent, so it can be extended again
+    return false;
+}
+
+SBVDEF size_t sv_lines_locate(const sv_lines_t *lines, size_t offset, size_t *column)
+{
+    if (lines == NULL || lines->count == 0 || offset > lines->len) return SIZE_MAX;
+
+    // last line starting at or before the offset
+    size_t lo = 0;
+    size_t n = lines->count;
+    while (n > 1){
+        size_t half = n / 2;
+        if (lines->starts[lo + half] <= offset) lo += half;
+        n -= half;
+    }
+    if (column) *column = offset - lines->starts[lo];
+    return lo;
+}
+
+SBVDEF sv_t sv_lines_get(const sv_lines_t *lines, sv_t sv, size_t line)
+{
+    if (lines == NULL || line >= lines->count || sv.len < lines->len) return sv_null();
+    size_t start = lines->starts[line];
+    size_t end = line + 1 < lines->count ? lines->starts[line + 1] - 1 : lines->len;
+    return sv_from_slice(sv.items + start, end - start);
+}
+
+SBVDEF void sv_lines_free(sv_lines_t *lines)
+{
+    if (lines == NULL) return;
+    SBV_FREE(lines->starts);
+    memset(lines, 0, sizeof(*lines));
+}
+
+typedef struct {
+    sv_t key;
+    size_t index;
+} sbv__trie_entry_t;
+
+static inline int sbv__trie_compare_fn(const void *a, const void *b)
+{
+    const sbv__trie_entry_t *x = a, *y = b;
+    int result = sv_compare(x->key, y->key);
+    if (result != 0) return result;
+    return (x->index < y->index) ? -1 : (x->index > y->index);
+}
+
+static inline int sbv__trie_compare_case_fn(const void *a, const void *b)
+{
+    const sbv__trie_entry_t *x = a, *y = b;
+    int result = sv_compare_case(x->key, y->key);
+    if (result != 0) return result;
+    return (x->index < y->index) ? -1 : (x->index > y->index);
+}
+
+static inline unsigned char sbv__trie_byte(const sv_trie_t *trie, char c)
+{
+    unsigned char b = (unsigned char) c;
+    if ((trie->flags & SV_TRIE_CASE) && b >= 'A' && b <= 'Z') b += 'a' - 'A';
+    return b;
+}
+
+SBVDEF bool sv_trie_build(sv_trie_t *trie, const sv_t *prefixes, size_t count, int flags)
+{
+    if (trie == NULL || (prefixes == NULL && count > 0)) return false;
+    memset(trie, 0, sizeof(*trie));
+    trie->flags = flags;
+
+    // every byte adds at most one node
+    size_t max_nodes = 1;
+    for (size_t i=0; i<count; ++i){
+        if (prefixes[i].items == NULL && prefixes[i].len > 0) return false;
+        if (prefixes[i].len > UINT32_MAX - max_nodes) return false;
+        max_nodes += prefixes[i].len;
+    }
+
+    sbv__trie_entry_t *entries = SBV_MALLOC(sizeof(*entries) * (count ? count : 1));
+    size_t *ranges = SBV_MALLOC(sizeof(*ranges) * 3 * max_nodes); // first entry, end entry and depth of every node
+    trie->children = SBV_MALLOC(sizeof(*trie->children) * (max_nodes + 1));
+    trie->labels = SBV_MALLOC(max_nodes);
+    trie->prefixes = SBV_MALLOC(sizeof(*trie->prefixes) * max_nodes);
+    if (entries == NULL || ranges == NULL || trie->children == NULL || trie->labels == NULL || trie->prefixes == NULL){
+        SBV_FREE(entries);
+        SBV_FREE(ranges);
+        sv_trie_free(trie);
+        return false;
+    }
+
+    for (size_t i=0; i<count; ++i){
+        entries[i].key = prefixes[i];
+        entries[i].index = i;
+    }
+    qsort(entries, count, sizeof(*entries), (flags & SV_TRIE_CASE) ? sbv__trie_compare_case_fn : sbv__trie_compare_fn);
+
+    // nodes are created breadth-first, each node owns the sorted entries sharing its path
+    trie->labels[0] = 0;
+    ranges[0] = 0;
+    ranges[1] = count;
+    ranges[2] = 0;
+    trie->nodes_count = 1;
+    for (size_t node=0; node<trie->nodes_count; ++node){
+        size_t lo = ranges[3*node], hi = ranges[3*node + 1], depth = ranges[3*node + 2];
+
+        trie->prefixes[node] = SIZE_MAX;
+        if (lo < hi && entries[lo].key.len == depth){
+            trie->prefixes[node] = entries[lo].index;
+            while (lo < hi && entries[lo].key.len == depth) lo += 1;
+        }
+
+        trie->children[node] = (uint32_t) trie->nodes_count;
+        while (lo < hi){
+            unsigned char label = sbv__trie_byte(trie, entries[lo].key.items[depth]);
+            size_t end = lo + 1;
+            while (end < hi && sbv__trie_byte(trie, entries[end].key.items[depth]) == label) end += 1;
+
+            size_t child = trie->nodes_count++;
+            trie->labels[child] = label;
+            ranges[3*child] = lo;
+            ranges[3*child + 1] = end;
+            ranges[3*child + 2] = depth + 1;
+            lo = end;
+        }
+    }
+    trie->children[trie->nodes_count] = (uint32_t) trie->nodes_count;
+
+    SBV_FREE(entries);
+    SBV_FREE(ranges);
+    return true;
+}
+
+// follow the edge labeled with a byte
+// return the child node, or 0 if there is none (the root is never a child)
+static inline size_t sbv__trie_step(const sv_trie_t *trie, size_t node, char c)
+{
+    size_t first = trie->children[node];
+    size_t n = trie->children[node + 1] - first;
+    if (n == 0) return 0;
+    const unsigned char *label = memchr(trie->labels + first, sbv__trie_byte(trie, c), n);
+    return label ? (size_t)(label - trie->labels) : 0;
+}
+
+SBVDEF size_t sv_trie_longest(const sv_trie_t *trie, sv_t sv)
+{
+    if (trie == NULL || trie->nodes_count == 0) return SIZE_MAX;
+    size_t node = 0;
+    size_t result = trie->prefixes[0];
+    for (size_t i=0; i<sv.len; ++i){
+        node = sbv__trie_step(trie, node, sv.items[i]);
+        if (node == 0) break;
+        if (trie->prefixes[node] != SIZE_MAX) result = trie->prefixes[node];
+    }
+    return result;
+}
+
+SBVDEF size_t sv_trie_all(const sv_trie_t *trie, sv_t sv, size_t *indices, size_t max)
+{
+    if (trie == NULL || trie->nodes_count == 0) return 0;
+    size_t node = 0;
+    size_t found = 0;
+    for (size_t i=0; ; ++i){
+        if (trie->prefixes[node] != SIZE_MAX){
+            if (indices && found < max) indices[found] = trie->prefixes[node];
+            found += 1;
+        }
+        if (i == sv.len) break;
+        node = sbv__trie_step(trie, node, sv.items[i]);
+        if (node == 0) break;
+    }
+    return found;
+}
+
+SBVDEF size_t sv_trie_exact(const sv_trie_t *trie, sv_t sv)
+{
+    if (trie == NULL || trie->nodes_count == 0) return SIZE_MAX;
+    size_t node = 0;
+    for (size_t i=0; i<sv.len; ++i){
+        node = sbv__trie_step(trie, node, sv.items[i]);
+        if (node == 0) return SIZE_MAX;
+    }
+    return trie->prefixes[node];
+}
+
+SBVDEF void sv_trie_free(sv_trie_t *trie)
+{
+    if (trie == NULL) return;
+    SBV_FREE(trie->children);
+    SBV_FREE(trie->labels);
+    SBV_FREE(trie->prefixes);
+    memset(trie, 0, sizeof(*trie));
+}
+
+// convert n bytes from src to dst, which may be the same buffer
+static inline void sbv__convert_case(char *dst, const char *src, size_t n, bool upper)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8){
+        uint64_t v = sbv__load64(src + i);
+        v = upper ? sbv__swar_upper(v) : sbv__swar_lower(v);
+        (void) memcpy(dst + i, &v, sizeof(v));
+    }
+    for (; i < n; ++i){
+        char c = src[i];
+        if (upper && c >= 'a' && c <= 'z') c -= 'a' - 'A';
+        if (!upper && c >= 'A' && c <= 'Z') c += 'a' - 'A';
+        dst[i] = c;
+    }
+}
+
+SBVDEF void sb_to_lower(sb_t *sb)
+{
+    if (sb == NULL || sb->items == NULL) return;
+    sbv__convert_case(sb->items, sb->items, sb->count, false);
+}
+
+SBVDEF void sb_to_upper(sb_t *sb)
+{
+    if (sb == NULL || sb->items == NULL) return;
+    sbv__convert_case(sb->items, sb->items, sb->count, true);
+}
+
+static inline sv_t sbv__convert_case_sv(sv_t sv, char *buff, size_t buff_size, bool upper)
+{
+    if (buff == NULL || sv_isnull(sv)) return sv_null();
+    if (buff_size == 0) return sv_from_slice(buff, 0);
+    size_t n = SBV_MIN(sv.len, buff_size - 1);
+    sbv__convert_case(buff, sv.items, n, upper);
+    buff[n] = '\0';
+    return sv_from_slice(buff, n);
+}
+
+SBVDEF sv_t sv_to_lower(sv_t sv, char *buff, size_t buff_size)
+{
+    return sbv__convert_case_sv(sv, buff, buff_size, false);
+}
+
+SBVDEF sv_t sv_to_upper(sv_t sv, char *buff, size_t buff_size)
+{
+    return sbv__convert_case_sv(sv, buff, buff_size, true);
+}
+
+static inline int sbv__append_case(sb_t *sb, sv_t sv, bool upper)
+{
+    if (sb == NULL || sv.items == NULL || sv.len > INT_MAX) return -1;
+    if (!sb_reserve(sb, sv.len)) return -1;
+    sbv__convert_case(sb->items + sb->count, sv.items, sv.len, upper);
+    sb->count += sv.len;
+    return sv.len;
+}
+
+SBVDEF int sb_append_lower(sb_t *sb, sv_t sv)
+{
+    return sbv__append_case(sb, sv, false);
+}
+
+SBVDEF int sb_append_upper(sb_t *sb, sv_t sv)
+{
+    return sbv__append_case(sb, sv, true);
+}
+
+SBVDEF void sv_translate_init(sv_translate_t *tr, sv_t from, sv_t to, sv_t del)
+{
+    if (tr == NULL) return;
+    for (int i=0; i<256; ++i) tr->map[i] = (int16_t) i;
+    for (size_t i=0; i<from.len; ++i){
+        tr->map[(unsigned char) from.items[i]] = to.len ? (unsigned char) to.items[SBV_MIN(i, to.len - 1)] : -1;
+    }
+    for (size_t i=0; i<del.len; ++i){
+        tr->map[(unsigned char) del.items[i]] = -1;
+    }
+}
+
+// translate n bytes from src to dst, which may be the same buffer, stopping once dst_size bytes are written
+// return the number of bytes written
+static inline size_t sbv__translate(char *dst, size_t dst_size, const char *src, size_t n, const sv_translate_t *tr)
+{
+    const unsigned char *in = (const unsigned char*) src;
+    size_t w = 0;
+    size_t i = 0;
+    // without deletions every byte maps to one byte, so the bounds check is hoisted out of the loop
+    if (n <= dst_size){
+        for (; i + 4 <= n; i += 4){
+            int16_t a = tr->map[in[i]], b = tr->map[in[i+1]], c = tr->map[in[i+2]], d = tr->map[in[i+3]];
+            if ((a | b | c | d) < 0) break;
+            dst[w] = (char) a;
+            dst[w+1] = (char) b;
+            dst[w+2] = (char) c;
+            dst[w+3] = (char) d;
+            w += 4;
+        }
+    }
+    for (; i < n && w < dst_size; ++i){
+        int16_t c = tr->map[in[i]];
+        if (c >= 0) dst[w++] = (char) c;
+    }
+    return w;
+}
+
+SBVDEF void sb_translate(sb_t *sb, const sv_translate_t *tr)
+{
+    if (sb == NULL || sb->items == NULL || tr == NULL) return;
+    sb->count = sbv__translate(sb->items, sb->count, sb->items, sb->count, tr);
+}
+
+SBVDEF sv_t sv_translate(sv_t sv, const sv_translate_t *tr, char *buff, size_t buff_size)
+{
+    if (buff == NULL || sv_isnull(sv) || tr == NULL) return sv_null();
+    if (buff_size == 0) return sv_from_slice(buff, 0);
+    size_t n = sbv__translate(buff, buff_size - 1, sv.items, sv.len, tr);
+    buff[n] = '\0';
+    return sv_from_slice(buff, n);
+}
+
+SBVDEF int sb_append_translated(sb_t *sb, sv_t sv, const sv_translate_t *tr)
+{
+    if (sb == NULL || sv.items == NULL || tr == NULL) return -1;
+    if (!sb_reserve(sb, sv.len)) return -1;
+    size_t n = sbv__translate(sb->items + sb->count, sv.len, sv.items, sv.len, tr);
+    if (n > INT_MAX) return -1;
+    sb->count += n;
+    return n;
+}
+
+SBVDEF sb_gap_t sb_gap_from_sb(sb_t *sb)
+{
+    sb_gap_t gap = {0};
+    if (sb == NULL) return gap;
+    gap.items = sb->items;
+    gap.gap_start = sb->count;
+    gap.gap_end = sb->capacity;
+    gap.capacity = sb->capacity;
+    sb->items = NULL;
+    sb->count = sb->capacity = 0;
+    return gap;
+}
+
+SBVDEF size_t sb_gap_len(const sb_gap_t *gap)
+{
+    if (gap == NULL) return 0;
+    return gap->capacity - (gap->gap_end - gap->gap_start);
+}
+
+// move the gap to an offset of the content
+static inline void sbv__gap_move(sb_gap_t *gap, size_t offset)
+{
+    if (offset < gap->gap_start){
+        size_t n = gap->gap_start - offset;
+        (void) memmove(gap->items + gap->gap_end - n, gap->items + offset, n);
+        gap->gap_start -= n;
+        gap->gap_end -= n;
+    } else if (offset > gap->gap_start){
+        size_t n = offset - gap->gap_start;
+        (void) memmove(gap->items + gap->gap_start, gap->items + gap->gap_end, n);
+        gap->gap_start += n;
+        gap->gap_end += n;
+    }
+}
+
+// make the gap at least n bytes wide, keeping room for a null-terminator like sb_reserve
+static inline bool sbv__gap_reserve(sb_gap_t *gap, size_t n)
+{
+    size_t len = sb_gap_len(gap);
+    if (gap->gap_end - gap->gap_start >= n + 1) return true;
+    if (n > SIZE_MAX - len - 1) return false;
+    size_t required = len + n + 1;
+    size_t capacity = gap->capacity ? gap->capacity : SB_INIT_CAPACITY;
+    while (capacity < required){
+        if (capacity > SIZE_MAX / 2){
+            capacity = SIZE_MAX;
+        } else{
+            capacity *= 2;
+        }
+    }
+    capacity = sbv__buffer_capacity(capacity);
+
+    // the text after the gap moves to the end of the new buffer
+    size_t after = gap->capacity - gap->gap_end;
+    char *new_items = sbv__buffer_resize(gap->items, gap->capacity, gap->capacity, capacity);
+    if (new_items == NULL) return false;
+    if (after > 0) (void) memmove(new_items + capacity - after, new_items + gap->gap_end, after);
+
+    gap->items = new_items;
+    gap->gap_end = capacity - after;
+    gap->capacity = capacity;
+    return true;
+}
+
+SBVDEF int sb_gap_insert(sb_gap_t *gap, size_t offset, sv_t sv)
+{
+    return sb_gap_replace(gap, offset, 0, sv);
+}
+
+SBVDEF int sb_gap_erase(sb_gap_t *gap, size_t offset, size_t n)
+{
+    if (gap == NULL || offset > sb_gap_len(gap)) return -1;
+    n = SBV_MIN(n, sb_gap_len(gap) - offset);
+    if (n > INT_MAX) return -1;
+    sbv__gap_move(gap, offset);
+    gap->gap_end += n;
+    return n;
+}
+
+SBVDEF int sb_gap_replace(sb_gap_t *gap, size_t offset, size_t n, sv_t sv)
+{
+    if (gap == NULL || sv.items == NULL || offset > sb_gap_len(gap) || sv.len > INT_MAX) return -1;
+    if (!sbv__gap_reserve(gap, sv.len)) return -1;
+
+    n = SBV_MIN(n, sb_gap_len(gap) - offset);
+    sbv__gap_move(gap, offset);
+    gap->gap_end += n;
+    (void) memcpy(gap->items + gap->gap_start, sv.items, sv.len);
+    gap->gap_start += sv.len;
+    return sv.len;
+}
+
+SBVDEF size_t sb_gap_segments(const sb_gap_t *gap, sv_t *first, sv_t *second)
+{
+    sv_t segments[2] = {sv_from_slice("", 0), sv_from_slice("", 0)};
+    size_t count = 0;
+    if (gap != NULL && gap->gap_start > 0){
+        segments[count++] = sv_from_slice(gap->items, gap->gap_start);
+    }
+    if (gap != NULL && gap->gap_end < gap->capacity){
+        segments[count++] = sv_from_slice(gap->items + gap->gap_end, gap->capacity - gap->gap_end);
+    }
+    if (first) *first = segments[0];
+    if (second) *second = segments[1];
+    return count;
+}
+
+SBVDEF sb_t sb_gap_compact(sb_gap_t *gap)
+{
+    sb_t sb = sb_null();
+    if (gap == NULL) return sb;
+    sbv__gap_move(gap, sb_gap_len(gap));
+    sb.items = gap->items;
+    sb.count = gap->gap_start;
+    sb.capacity = gap->capacity;
+    memset(gap, 0, sizeof(*gap));
+    return sb;
+}
+
+SBVDEF void sb_gap_free(sb_gap_t *gap)
+{
+    if (gap == NULL) return;
+    sbv__buffer_free(gap->items, gap->capacity);
+    memset(gap, 0, sizeof(*gap));
+}
+
+#ifdef SBV__HAS_ATOMICS
+#define SBV__CACHE_LINE 64
+
+typedef struct sbv__segment sbv__segment_t;
+
+// writers reserve space in the current segment with a fetch-add on `reserved`; the writer whose reservation
+// crosses the capacity seals the segment by storing the end of the valid data in `size`, and all writers that
+// did not fit race to link and install the next segment
+struct sbv__segment {
+    SBV__ATOMIC(size_t) reserved;    // bytes reserved, grows past the capacity once the segment is full
+    char pad0[SBV__CACHE_LINE - sizeof(size_t)];
+    SBV__ATOMIC(size_t) committed;   // bytes written
+    char pad1[SBV__CACHE_LINE - sizeof(size_t)];
+    SBV__ATOMIC(size_t) size;        // bytes of data once sealed, SIZE_MAX before
+    SBV__ATOMIC(sbv__segment_t*) next;
+    size_t capacity;
+    size_t consumed;                 // bytes handed out by sb_concurrent_drain
+    size_t retired_epoch;            // epoch in which the segment was unlinked
+    sbv__segment_t *retired_next;
+    char items[];
+};
+
+// segments are freed by the consumer with epoch based reclamation: writers pin the epoch they run in, and a
+// segment unlinked in epoch e is freed once no writer of epoch e or earlier can remain, i.e. at epoch e + 2
+struct sb_concurrent {
+    SBV__ATOMIC(sbv__segment_t*) current;
+    char pad0[SBV__CACHE_LINE - sizeof(void*)];
+    SBV__ATOMIC(size_t) epoch;
+    char pad1[SBV__CACHE_LINE - sizeof(size_t)];
+    SBV__ATOMIC(size_t) active[2];   // writers pinned in even and odd epochs
+    char pad2[SBV__CACHE_LINE - 2 * sizeof(size_t)];
+    sbv__segment_t *head;            // oldest segment not drained yet
+    sbv__segment_t *retired;         // unlinked segments waiting to be freed
+    size_t segment_size;
+};
+
+static inline sbv__segment_t* sbv__segment_create(size_t capacity)
+{
+    sbv__segment_t *seg = SBV_MALLOC(sizeof(*seg) + capacity);
+    if (seg == NULL) return NULL;
+    seg->reserved = 0;
+    seg->committed = 0;
+    seg->size = SIZE_MAX;
+    seg->next = NULL;
+    seg->capacity = capacity;
+    seg->consumed = 0;
+    seg->retired_epoch = 0;
+    seg->retired_next = NULL;
+    return seg;
+}
+
+SBVDEF sb_concurrent_t* sb_concurrent_create(size_t segment_size)
+{
+    sb_concurrent_t *sb = SBV_MALLOC(sizeof(*sb));
+    if (sb == NULL) return NULL;
+    memset(sb, 0, sizeof(*sb));
+    sb->segment_size = segment_size ? segment_size : SB_CONCURRENT_SEGMENT_SIZE;
+    sb->head = sbv__segment_create(sb->segment_size);
+    if (sb->head == NULL){
+        SBV_FREE(sb);
+        return NULL;
+    }
+    sb->current = sb->head;
+    return sb;
+}
+
+SBVDEF int sb_concurrent_append(sb_concurrent_t *sb, sv_t sv)
+{
+    if (sb == NULL || sv.items == NULL || sv.len > INT_MAX) return -1;
+    size_t n = sv.len;
+    if (n == 0) return 0;
+
+    // pin the epoch, retrying if it moved before the pin became visible
+    size_t epoch;
+    for (;;){
+        epoch = SBV__ATOMIC_LOAD(&sb->epoch);
+        (void) SBV__ATOMIC_FETCH_ADD(&sb->active[epoch & 1], 1);
+        SBV__ATOMIC_FENCE();
+        if (SBV__ATOMIC_LOAD(&sb->epoch) == epoch) break;
+        (void) SBV__ATOMIC_FETCH_SUB(&sb->active[epoch & 1], 1);
+    }
+
+    int result = (int) n;
+    for (;;){
+        sbv__segment_t *seg = SBV__ATOMIC_LOAD(&sb->current);
+        size_t offset = SBV__ATOMIC_FETCH_ADD(&seg->reserved, n);
+        if (offset <= seg->capacity && n <= seg->capacity - offset){
+            (void) memcpy(seg->items + offset, sv.items, n);
+            (void) SBV__ATOMIC_FETCH_ADD(&seg->committed, n);
+            break;
+        }
+        if (offset <= seg->capacity) SBV__ATOMIC_STORE(&seg->size, offset);
+
+        sbv__segment_t *next = SBV__ATOMIC_LOAD(&seg->next);
+        if (next == NULL){
+            sbv__segment_t *created = sbv__segment_create(n > sb->segment_size ? n : sb->segment_size);
+            if (created == NULL){
+                result = -1;
+                break;
+            }
+            if (SBV__ATOMIC_CAS(&seg->next, &next, created)){
+                next = created;
+            } else{
+                SBV_FREE(created);
+            }
+        }
+        (void) SBV__ATOMIC_CAS(&sb->current, &seg, next);
+    }
+
+    (void) SBV__ATOMIC_FETCH_SUB(&sb->active[epoch & 1], 1);
+    return result;
+}
+
+SBVDEF int sb_concurrent_appendf(sb_concurrent_t *sb, const char *fmt, ...)
+{
+    if (sb == NULL) return -1;
+
+    va_list args;
+    va_start(args, fmt);
+
+    int n = sb_concurrent_vappendf(sb, fmt, args);
+
+    va_end(args);
+    return n;
+}
+
+SBVDEF int sb_concurrent_vappendf(sb_concurrent_t *sb, const char *fmt, va_list args)
+{
+    if (sb == NULL) return -1;
+
+    // the record is formatted aside, so that its null-terminator can not clobber another writer's record
+    char stack[256];
+    va_list args_copy;
+    va_copy(args_copy, args);
+    int n = vsnprintf(stack, sizeof(stack), fmt, args_copy);
+    va_end(args_copy);
+    if (n < 0) return n;
+    if ((size_t) n < sizeof(stack)) return sb_concurrent_append(sb, sv_from_slice(stack, n));
+
+    char *heap = SBV_MALLOC((size_t) n + 1);
+    if (heap == NULL) return -1;
+    int w = vsnprintf(heap, (size_t) n + 1, fmt, args);
+    int result = (w == n) ? sb_concurrent_append(sb, sv_from_slice(heap, n)) : -1;
+    SBV_FREE(heap);
+    return result;
+}
+
+// advance the epoch if no writer of the previous one is left, and free the segments no writer can reach anymore
+static inline void sbv__concurrent_reclaim(sb_concurrent_t *sb)
+{
+    size_t epoch = SBV__ATOMIC_LOAD(&sb->epoch);
+    SBV__ATOMIC_FENCE();
+    if (SBV__ATOMIC_LOAD(&sb->active[(epoch + 1) & 1]) == 0){
+        epoch += 1;
+        SBV__ATOMIC_STORE(&sb->epoch, epoch);
+    }
+
+    sbv__segment_t **it = &sb->retired;
+    while (*it != NULL){
+        sbv__segment_t *seg = *it;
+        if (seg->retired_epoch + 2 <= epoch){
+            *it = seg->retired_next;
+            SBV_FREE(seg);
+        } else{
+            it = &seg->retired_next;
+        }
+    }
+}
+
+SBVDEF sv_t sb_concurrent_drain(sb_concurrent_t *sb)
+{
+    if (sb == NULL) return sv_null();
+
+    for (;;){
+        sbv__concurrent_reclaim(sb);
+        sbv__segment_t *seg = sb->head;
+
+        // data is complete up to the sealed size once every write finished, and in an open segment
+        // up to any point where the writes finished caught up with the reservations
+        size_t limit = seg->consumed;
+        size_t size = SBV__ATOMIC_LOAD(&seg->size);
+        size_t committed = SBV__ATOMIC_LOAD(&seg->committed);
+        if (size != SIZE_MAX){
+            if (committed == size) limit = size;
+        } else if (SBV__ATOMIC_LOAD(&seg->reserved) == committed){
+            limit = committed;
+        }
+
+        if (limit > seg->consumed){
+            sv_t chunk = sv_from_slice(seg->items + seg->consumed, limit - seg->consumed);
+            seg->consumed = limit;
+            return chunk;
+        }
+        if (size == SIZE_MAX || seg->consumed < size) return sv_null();
+
+        sbv__segment_t *next = SBV__ATOMIC_LOAD(&seg->next);
+        if (next == NULL) return sv_null();
+
+        // unlink the drained segment, no writer can find it after this point
+        sbv__segment_t *expected = seg;
+        (void) SBV__ATOMIC_CAS(&sb->current, &expected, next);
+        seg->retired_epoch = SBV__ATOMIC_LOAD(&sb->epoch);
+        seg->retired_next = sb->retired;
+        sb->retired = seg;
+        sb->head = next;
+    }
+}
+
+SBVDEF void sb_concurrent_free(sb_concurrent_t *sb)
+{
+    if (sb == NULL) return;
+    for (sbv__segment_t *seg = sb->retired; seg != NULL;){
+        sbv__segment_t *next = seg->retired_next;
+        SBV_FREE(seg);
+        seg = next;
+    }
+    for (sbv__segment_t *seg = sb->head; seg != NULL;){
+        sbv__segment_t *next = seg->next;
+        SBV_FREE(seg);
+        seg = next;
+    }
+    SBV_FREE(sb);
+}
+#endif // SBV__HAS_ATOMICS
+
+SBVDEF bool sv_schema_compile(sv_schema_t *schema, const sv_t *keys, size_t count, char field_sep, char pair_sep, int flags)
+{
+    if (schema == NULL || field_sep == pair_sep) return false;
+    memset(schema, 0, sizeof(*schema));
+
+    sv_t *trimmed = SBV_MALLOC(sizeof(*trimmed) * (count ? count : 1));
+    if (trimmed == NULL) return false;
+    for (size_t i=0; i<count; ++i) trimmed[i] = sv_trim(keys[i]);
+    bool ok = sv_trie_build(&schema->keys, trimmed, count, (flags & SV_SCHEMA_CASE) ? SV_TRIE_CASE : 0);
+    SBV_FREE(trimmed);
+    if (!ok) return false;
+
+    schema->count = count;
+    schema->field_sep = field_sep;
+    schema->pair_sep = pair_sep;
+    return true;
+}
+
+// find the first of up to three bytes, 8 bytes at a time
+// return its index, or n if none of them occurs
+static inline size_t sbv__find_any(const char *p, size_t i, size_t n, char a, char b, char c)
+{
+    for (; i + 8 <= n; i += 8){
+        uint64_t v = sbv__load64(p + i);
+        if (SBV__HAS_BYTE(v, a) | SBV__HAS_BYTE(v, b) | SBV__HAS_BYTE(v, c)) break;
+    }
+    for (; i < n; ++i){
+        if (p[i] == a || p[i] == b || p[i] == c) return i;
+    }
+    return n;
+}
+
+SBVDEF size_t sv_schema_extract(const sv_schema_t *schema, sv_t record, sv_t *values)
+{
+    if (schema == NULL || (values == NULL && schema->count > 0)) return 0;
+    for (size_t i=0; i<schema->count; ++i) values[i] = sv_null();
+    if (record.items == NULL) return 0;
+
+    const char *p = record.items;
+    size_t n = record.len;
+    char fs = schema->field_sep, ps = schema->pair_sep;
+    size_t found = 0;
+    size_t i = 0;
+    while (i < n && found < schema->count){
+        size_t start = i;
+        i = sbv__find_any(p, i, n, ps, fs, fs);
+        if (i == n || p[i] == fs){
+            i += 1; // a field without a value
+            continue;
+        }
+        size_t slot = sv_trie_exact(&schema->keys, sv_trim(sv_from_slice(p + start, i - start)));
+
+        // skip leading whitespace of the value
+        i += 1;
+        while (i < n && p[i] != fs && memchr(SBV_WHITESPACE, p[i], sizeof(SBV_WHITESPACE) - 1) != NULL) i += 1;
+
+        sv_t value;
+        if (i < n && p[i] == '"'){
+            size_t open = ++i;
+            for (;;){
+                i = sbv__find_any(p, i, n, '"', '\\', '"');
+                if (i < n && p[i] == '\\'){
+                    i += 2;
+                    continue;
+                }
+                break;
+            }
+            i = SBV_MIN(i, n);
+            value = sv_from_slice(p + open, i - open);
+            // anything between the closing quote and the next field is ignored
+            i = (i < n) ? sbv__find_any(p, i, n, fs, fs, fs) : n;
+        } else{
+            size_t open = i;
+            i = sbv__find_any(p, i, n, fs, fs, fs);
+            value = sv_trim(sv_from_slice(p + open, i - open));
+        }
+        i += 1;
+
+        if (slot != SIZE_MAX && values[slot].items == NULL){
+            values[slot] = value;
+            found += 1;
+        }
+    }
+    return found;
+}
+
+SBVDEF void sv_schema_free(sv_schema_t *schema)
+{
+    if (schema == NULL) return;
+    sv_trie_free(&schema->keys);
+    memset(schema, 0, sizeof(*schema));
+}
+
+#endif // SBV_IMPLEMENTATION
+
+#if defined(SBV_PROFILE) && !defined(SBV__PROFILE_WRAPPERS)
+#define SBV__PROFILE_WRAPPERS
+
+// every profiled function is replaced by a macro that passes the call site to a wrapper, which times the call
+// `bytes` is evaluated after the call and may refer to the parameters and to `sbv__result`
+#define SBV__UNPAREN(...) __VA_ARGS__
+#define SBV__PROFILE_WRAP(ret, name, params, args, bytes) \
+    static inline ret sbv__profiled_##name(const char *sbv__file, int sbv__line, SBV__UNPAREN params) \
+    { \
+        uint64_t sbv__start = sbv_profile_ticks(); \
+        ret sbv__result = (name) args; \
+        uint64_t sbv__ticks = sbv_profile_ticks() - sbv__start; \
+        sbv_profile_record(#name, sbv__file, sbv__line, (size_t)(bytes), sbv__ticks); \
+        return sbv__result; \
+    }
+#define SBV__PROFILE_WRAP_VOID(name, params, args) \
+    static inline void sbv__profiled_##name(const char *sbv__file, int sbv__line, SBV__UNPAREN params) \
+    { \
+        uint64_t sbv__start = sbv_profile_ticks(); \
+        (name) args; \
+        sbv_profile_record(#name, sbv__file, sbv__line, 0, sbv_profile_ticks() - sbv__start); \
+    }
+#define SBV__PROFILED_BYTES(n) ((n) > 0 ? (n) : 0)
+
+SBV__PROFILE_WRAP(int, sb_vappendf, (sb_t *sb, const char *fmt, va_list args), (sb, fmt, args), SBV__PROFILED_BYTES(sbv__result))
+SBV__PROFILE_WRAP(int, sb_append_cstr, (sb_t *sb, const char *cstr), (sb, cstr), SBV__PROFILED_BYTES(sbv__result))
+SBV__PROFILE_WRAP(int, sb_append_slice, (sb_t *sb, const char *buff, size_t n), (sb, buff, n), n)
+SBV__PROFILE_WRAP(int, sb_append_sv, (sb_t *sb, sv_t sv), (sb, sv), sv.len)
+SBV__PROFILE_WRAP(int, sb_append_many, (sb_t *sb, const sv_t *svs, size_t count), (sb, svs, count), SBV__PROFILED_BYTES(sbv__result))
+SBV__PROFILE_WRAP(int, sb_join, (sb_t *sb, const sv_t *svs, size_t count, sv_t sep, sv_t prefix, sv_t suffix), (sb, svs, count, sep, prefix, suffix), SBV__PROFILED_BYTES(sbv__result))
+SBV__PROFILE_WRAP(int, sb_append_char, (sb_t *sb, char c), (sb, c), 1)
+SBV__PROFILE_WRAP(int, sb_append_null, (sb_t *sb), (sb), 0)
+SBV__PROFILE_WRAP(int, sb_append_file, (sb_t *sb, const char *filename), (sb, filename), SBV__PROFILED_BYTES(sbv__result))
+SBV__PROFILE_WRAP(ptrdiff_t, sb_append_cstr_z, (sb_t *sb, const char *cstr), (sb, cstr), SBV__PROFILED_BYTES(sbv__result))
+SBV__PROFILE_WRAP(ptrdiff_t, sb_append_slice_z, (sb_t *sb, const char *buff, size_t n), (sb, buff, n), SBV__PROFILED_BYTES(sbv__result))
+SBV__PROFILE_WRAP(ptrdiff_t, sb_append_sv_z, (sb_t *sb, sv_t sv), (sb, sv), SBV__PROFILED_BYTES(sbv__result))
+SBV__PROFILE_WRAP(ptrdiff_t, sb_append_file_z, (sb_t *sb, const char *filename), (sb, filename), SBV__PROFILED_BYTES(sbv__result))
+SBV__PROFILE_WRAP(ptrdiff_t, sb_extract_z, (const sb_t *sb, char *buff, size_t buff_size), (sb, buff, buff_size), SBV__PROFILED_BYTES(sbv__result))
+SBV__PROFILE_WRAP(ptrdiff_t, sb_extract_slice_z, (const sb_t *sb, size_t n, char *buff, size_t buff_size), (sb, n, buff, buff_size), SBV__PROFILED_BYTES(sbv__result))
+SBV__PROFILE_WRAP(ptrdiff_t, sv_extract_z, (sv_t sv, char *buff, size_t buff_size), (sv, buff, buff_size), SBV__PROFILED_BYTES(sbv__result))
+SBV__PROFILE_WRAP(int, sb_pop, (sb_t *sb, size_t n), (sb, n), SBV__PROFILED_BYTES(sbv__result))
+SBV__PROFILE_WRAP(ptrdiff_t, sb_pop_z, (sb_t *sb, size_t n), (sb, n), SBV__PROFILED_BYTES(sbv__result))
+SBV__PROFILE_WRAP(int, sb_extract, (const sb_t *sb, char *buff, size_t buff_size), (sb, buff, buff_size), SBV__PROFILED_BYTES(sbv__result))
+SBV__PROFILE_WRAP(int, sb_extract_slice, (const sb_t *sb, size_t n, char *buff, size_t buff_size), (sb, n, buff, buff_size), SBV__PROFILED_BYTES(sbv__result))
+SBV__PROFILE_WRAP(char*, sb_to_cstr, (const sb_t *sb), (sb), sb ? sb->count : 0)
+SBV__PROFILE_WRAP(char*, sb_detach, (sb_t *sb), (sb), 0)
+SBV__PROFILE_WRAP(bool, sb_reserve, (sb_t *sb, size_t bytes), (sb, bytes), bytes)
+SBV__PROFILE_WRAP(bool, sb_shrink_to_fit, (sb_t *sb), (sb), 0)
+SBV__PROFILE_WRAP_VOID(sb_free, (sb_t *sb), (sb))
+#ifdef SBV_POOL
+SBV__PROFILE_WRAP(sb_t, sb_pool_acquire, (size_t capacity), (capacity), capacity)
+#endif // SBV_POOL
+
+SBV__PROFILE_WRAP(sv_t, sv_from_cstr, (const char *cstr), (cstr), sbv__result.len)
+SBV__PROFILE_WRAP(sv_t, sv_from_vformat, (char *buff, size_t buff_size, const char *fmt, va_list args), (buff, buff_size, fmt, args), sbv__result.len)
+SBV__PROFILE_WRAP(bool, sv_equals, (sv_t a, sv_t b), (a, b), a.len)
+SBV__PROFILE_WRAP(bool, sv_equals_case, (sv_t a, sv_t b), (a, b), a.len)
+SBV__PROFILE_WRAP(int, sv_compare, (sv_t a, sv_t b), (a, b), SBV_MIN(a.len, b.len))
+SBV__PROFILE_WRAP(int, sv_compare_case, (sv_t a, sv_t b), (a, b), SBV_MIN(a.len, b.len))
+SBV__PROFILE_WRAP(bool, sv_starts_with, (sv_t sv, sv_t prefix), (sv, prefix), prefix.len)
+SBV__PROFILE_WRAP(bool, sv_starts_with_case, (sv_t sv, sv_t prefix), (sv, prefix), prefix.len)
+SBV__PROFILE_WRAP(bool, sv_ends_with, (sv_t sv, sv_t suffix), (sv, suffix), suffix.len)
+SBV__PROFILE_WRAP(bool, sv_ends_with_case, (sv_t sv, sv_t suffix), (sv, suffix), suffix.len)
+SBV__PROFILE_WRAP(size_t, sv_find, (sv_t sv, sv_t query), (sv, query), sv.len)
+SBV__PROFILE_WRAP(size_t, sv_find_case, (sv_t sv, sv_t query), (sv, query), sv.len)
+SBV__PROFILE_WRAP(size_t, sv_find_char, (sv_t sv, char query), (sv, query), sv.len)
+SBV__PROFILE_WRAP(size_t, sv_count, (sv_t sv, sv_t query), (sv, query), sv.len)
+SBV__PROFILE_WRAP(size_t, sv_count_case, (sv_t sv, sv_t query), (sv, query), sv.len)
+SBV__PROFILE_WRAP(size_t, sv_count_char, (sv_t sv, char query), (sv, query), sv.len)
+SBV__PROFILE_WRAP(bool, sv_contains, (sv_t sv, sv_t query), (sv, query), sv.len)
+SBV__PROFILE_WRAP(bool, sv_contains_case, (sv_t sv, sv_t query), (sv, query), sv.len)
+SBV__PROFILE_WRAP(bool, sv_contains_char, (sv_t sv, char query), (sv, query), sv.len)
+SBV__PROFILE_WRAP(sv_t, sv_split, (sv_t sv, sv_t del, sv_t *rest), (sv, del, rest), sbv__result.len)
+SBV__PROFILE_WRAP(sv_t, sv_split_case, (sv_t sv, sv_t del, sv_t *rest), (sv, del, rest), sbv__result.len)
+SBV__PROFILE_WRAP(sv_t, sv_split_char, (sv_t sv, char del, sv_t *rest), (sv, del, rest), sbv__result.len)
+SBV__PROFILE_WRAP(size_t, sv_split_count, (sv_t sv, sv_t del), (sv, del), sv.len)
+SBV__PROFILE_WRAP(size_t, sv_split_case_count, (sv_t sv, sv_t del), (sv, del), sv.len)
+SBV__PROFILE_WRAP(size_t, sv_split_char_count, (sv_t sv, char del), (sv, del), sv.len)
+SBV__PROFILE_WRAP(sv_t, sv_trim, (sv_t sv), (sv), sv.len - sbv__result.len)
+SBV__PROFILE_WRAP(sv_t, sv_trim_chars, (sv_t sv, const char *chars), (sv, chars), sv.len - sbv__result.len)
+SBV__PROFILE_WRAP(sv_t, sv_trim_seq, (sv_t sv, sv_t seq, size_t iterations), (sv, seq, iterations), sv.len - sbv__result.len)
+SBV__PROFILE_WRAP(sv_t, sv_trim_left, (sv_t sv), (sv), sv.len - sbv__result.len)
+SBV__PROFILE_WRAP(sv_t, sv_trim_left_chars, (sv_t sv, const char *chars), (sv, chars), sv.len - sbv__result.len)
+SBV__PROFILE_WRAP(sv_t, sv_trim_left_seq, (sv_t sv, sv_t seq, size_t iterations), (sv, seq, iterations), sv.len - sbv__result.len)
+SBV__PROFILE_WRAP(sv_t, sv_trim_right, (sv_t sv), (sv), sv.len - sbv__result.len)
+SBV__PROFILE_WRAP(sv_t, sv_trim_right_chars, (sv_t sv, const char *chars), (sv, chars), sv.len - sbv__result.len)
+SBV__PROFILE_WRAP(sv_t, sv_trim_right_seq, (sv_t sv, sv_t seq, size_t iterations), (sv, seq, iterations), sv.len - sbv__result.len)
+SBV__PROFILE_WRAP(sv_t, sv_append, (sv_t a, sv_t b, char *buff, size_t buff_size), (a, b, buff, buff_size), sbv__result.len)
+SBV__PROFILE_WRAP(sv_t, sv_append_many, (const sv_t *svs, size_t count, char *buff, size_t buff_size), (svs, count, buff, buff_size), sbv__result.len)
+SBV__PROFILE_WRAP(size_t, sv_append_many_len, (const sv_t *svs, size_t count), (svs, count), 0)
+SBV__PROFILE_WRAP(sv_t, sv_join, (const sv_t *svs, size_t count, sv_t sep, char *buff, size_t buff_size), (svs, count, sep, buff, buff_size), sbv__result.len)
+SBV__PROFILE_WRAP(size_t, sv_join_len, (const sv_t *svs, size_t count, sv_t sep), (svs, count, sep), 0)
+SBV__PROFILE_WRAP(sv_t, sv_replace, (sv_t sv, sv_t query, sv_t replace, char *buff, size_t buff_size), (sv, query, replace, buff, buff_size), sv.len)
+SBV__PROFILE_WRAP(size_t, sv_replace_len, (sv_t sv, sv_t query, sv_t replace), (sv, query, replace), sv.len)
+SBV__PROFILE_WRAP(int, sv_extract, (sv_t sv, char *buff, size_t buff_size), (sv, buff, buff_size), SBV__PROFILED_BYTES(sbv__result))
+SBV__PROFILE_WRAP(char*, sv_to_cstr, (sv_t sv), (sv), sv.len)
+
+#ifdef SBV_THREADS
+SBV__PROFILE_WRAP(sv_t, sv_reader_next, (sv_reader_t *reader), (reader), sbv__result.len)
+SBV__PROFILE_WRAP_VOID(sv_sort_parallel, (sv_t *svs, size_t count, size_t threads), (svs, count, threads))
+SBV__PROFILE_WRAP_VOID(sv_sort_case_parallel, (sv_t *svs, size_t count, size_t threads), (svs, count, threads))
+#endif // SBV_THREADS
+SBV__PROFILE_WRAP_VOID(sv_sort, (sv_t *svs, size_t count), (svs, count))
+SBV__PROFILE_WRAP_VOID(sv_sort_case, (sv_t *svs, size_t count), (svs, count))
+SBV__PROFILE_WRAP(size_t, sv_dedup, (sv_t *svs, size_t count), (svs, count), 0)
+SBV__PROFILE_WRAP(size_t, sv_dedup_case, (sv_t *svs, size_t count), (svs, count), 0)
+
+SBV__PROFILE_WRAP(int, sb_append_json_escaped, (sb_t *sb, sv_t sv), (sb, sv), sv.len)
+SBV__PROFILE_WRAP(int, sb_append_url_encoded, (sb_t *sb, sv_t sv), (sb, sv), sv.len)
+SBV__PROFILE_WRAP(int, sb_append_c_escaped, (sb_t *sb, sv_t sv), (sb, sv), sv.len)
+SBV__PROFILE_WRAP(int, sb_append_shell_escaped, (sb_t *sb, sv_t sv), (sb, sv), sv.len)
+SBV__PROFILE_WRAP(int, sb_append_url_decoded, (sb_t *sb, sv_t sv, size_t *error_offset), (sb, sv, error_offset), sv.len)
+SBV__PROFILE_WRAP(int, sb_append_c_unescaped, (sb_t *sb, sv_t sv, size_t *error_offset), (sb, sv, error_offset), sv.len)
+SBV__PROFILE_WRAP(int, sb_append_base64_encoded, (sb_t *sb, sv_t sv, int flags), (sb, sv, flags), sv.len)
+SBV__PROFILE_WRAP(int, sb_append_hex_encoded, (sb_t *sb, sv_t sv), (sb, sv), sv.len)
+SBV__PROFILE_WRAP(int, sb_append_base64_decoded, (sb_t *sb, sv_t sv, int flags, size_t *error_offset), (sb, sv, flags, error_offset), sv.len)
+SBV__PROFILE_WRAP(int, sb_append_hex_decoded, (sb_t *sb, sv_t sv, size_t *error_offset), (sb, sv, error_offset), sv.len)
+
+static inline int sbv__profiled_sb_appendf(const char *sbv__file, int sbv__line, sb_t *sb, const char *fmt, ...) SBV_PRINTF_FORMAT(4, 5);
+static inline int sbv__profiled_sb_appendf(const char *sbv__file, int sbv__line, sb_t *sb, const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    uint64_t sbv__start = sbv_profile_ticks();
+    int sbv__result = (sb_vappendf)(sb, fmt, args);
+    uint64_t sbv__ticks = sbv_profile_ticks() - sbv__start;
+    va_end(args);
+    sbv_profile_record("sb_appendf", sbv__file, sbv__line, SBV__PROFILED_BYTES(sbv__result), sbv__ticks);
+    return sbv__result;
+}
+
+static inline sv_t sbv__profiled_sv_from_format(const char *sbv__file, int sbv__line, char *buff, size_t buff_size, const char *fmt, ...) SBV_PRINTF_FORMAT(5, 6);
+static inline sv_t sbv__profiled_sv_from_format(const char *sbv__file, int sbv__line, char *buff, size_t buff_size, const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    uint64_t sbv__start = sbv_profile_ticks();
+    sv_t sbv__result = (sv_from_vformat)(buff, buff_size, fmt, args);
+    uint64_t sbv__ticks = sbv_profile_ticks() - sbv__start;
+    va_end(args);
+    sbv_profile_record("sv_from_format", sbv__file, sbv__line, sbv__result.len, sbv__ticks);
+    return sbv__result;
+}
+
+static inline int sbv__profiled_sb_concurrent_appendf(const char *sbv__file, int sbv__line, sb_concurrent_t *sb, const char *fmt, ...) SBV_PRINTF_FORMAT(4, 5);
+static inline int sbv__profiled_sb_concurrent_appendf(const char *sbv__file, int sbv__line, sb_concurrent_t *sb, const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    uint64_t sbv__start = sbv_profile_ticks();
+    int sbv__result = (sb_concurrent_vappendf)(sb, fmt, args);
+    uint64_t sbv__ticks = sbv_profile_ticks() - sbv__start;
+    va_end(args);
+    sbv_profile_record("sb_concurrent_appendf", sbv__file, sbv__line, SBV__PROFILED_BYTES(sbv__result), sbv__ticks);
+    return sbv__result;
+}
+
+SBV__PROFILE_WRAP(int, sb_concurrent_append, (sb_concurrent_t *sb, sv_t sv), (sb, sv), SBV__PROFILED_BYTES(sbv__result))
+SBV__PROFILE_WRAP(int, sb_concurrent_vappendf, (sb_concurrent_t *sb, const char *fmt, va_list args), (sb, fmt, args), SBV__PROFILED_BYTES(sbv__result))
+
+SBV__PROFILE_WRAP(bool, sv_glob_match, (const sv_glob_t *glob, sv_t sv), (glob, sv), sv.len)
+SBV__PROFILE_WRAP(size_t, sv_glob_match_many, (const sv_glob_t *globs, size_t count, sv_t sv, bool *matches), (globs, count, sv, matches), sv.len * count)
+SBV__PROFILE_WRAP(size_t, sv_edit_distance, (sv_t a, sv_t b), (a, b), a.len + b.len)
+SBV__PROFILE_WRAP(size_t, sv_edit_distance_bounded, (sv_t a, sv_t b, size_t max_distance), (a, b, max_distance), a.len + b.len)
+SBV__PROFILE_WRAP(size_t, sv_find_approx, (sv_t sv, sv_t query, size_t max_distance, size_t *match_len), (sv, query, max_distance, match_len), sv.len)
+SBV__PROFILE_WRAP(bool, sv_lines_build, (sv_lines_t *lines, sv_t sv), (lines, sv), sv.len)
+SBV__PROFILE_WRAP(bool, sv_lines_extend, (sv_lines_t *lines, sv_t sv), (lines, sv), sv.len)
+SBV__PROFILE_WRAP(size_t, sv_trie_longest, (const sv_trie_t *trie, sv_t sv), (trie, sv), sv.len)
+SBV__PROFILE_WRAP(size_t, sv_trie_all, (const sv_trie_t *trie, sv_t sv, size_t *indices, size_t max), (trie, sv, indices, max), sv.len)
+SBV__PROFILE_WRAP(size_t, sv_trie_exact, (const sv_trie_t *trie, sv_t sv), (trie, sv), sv.len)
+SBV__PROFILE_WRAP_VOID(sb_to_lower, (sb_t *sb), (sb))
+SBV__PROFILE_WRAP_VOID(sb_to_upper, (sb_t *sb), (sb))
+SBV__PROFILE_WRAP(sv_t, sv_to_lower, (sv_t sv, char *buff, size_t buff_size), (sv, buff, buff_size), sbv__result.len)
+SBV__PROFILE_WRAP(sv_t, sv_to_upper, (sv_t sv, char *buff, size_t buff_size), (sv, buff, buff_size), sbv__result.len)
+SBV__PROFILE_WRAP(int, sb_append_lower, (sb_t *sb, sv_t sv), (sb, sv), sv.len)
+SBV__PROFILE_WRAP(int, sb_append_upper, (sb_t *sb, sv_t sv), (sb, sv), sv.len)
+SBV__PROFILE_WRAP_VOID(sb_translate, (sb_t *sb, const sv_translate_t *tr), (sb, tr))
+SBV__PROFILE_WRAP(sv_t, sv_translate, (sv_t sv, const sv_translate_t *tr, char *buff, size_t buff_size), (sv, tr, buff, buff_size), sv.len)
+SBV__PROFILE_WRAP(int, sb_append_translated, (sb_t *sb, sv_t sv, const sv_translate_t *tr), (sb, sv, tr), sv.len)
+SBV__PROFILE_WRAP(int, sb_gap_insert, (sb_gap_t *gap, size_t offset, sv_t sv), (gap, offset, sv), SBV__PROFILED_BYTES(sbv__result))
+SBV__PROFILE_WRAP(int, sb_gap_erase, (sb_gap_t *gap, size_t offset, size_t n), (gap, offset, n), SBV__PROFILED_BYTES(sbv__result))
+SBV__PROFILE_WRAP(int, sb_gap_replace, (sb_gap_t *gap, size_t offset, size_t n, sv_t sv), (gap, offset, n, sv), SBV__PROFILED_BYTES(sbv__result))
+SBV__PROFILE_WRAP(size_t, sv_schema_extract, (const sv_schema_t *schema, sv_t record, sv_t *values), (schema, record, values), record.len)
+SBV__PROFILE_WRAP(int, sb_template_render, (sb_t *sb, const sb_template_t *tpl, const sb_template_arg_t *args, size_t count), (sb, tpl, args, count), SBV__PROFILED_BYTES(sbv__result))
+
+#define SBV__PROFILED(name, ...) sbv__profiled_##name(__FILE__, __LINE__, __VA_ARGS__)
+
+#define sb_appendf(...)             SBV__PROFILED(sb_appendf, __VA_ARGS__)
+#define sb_vappendf(...)            SBV__PROFILED(sb_vappendf, __VA_ARGS__)
+#define sb_append_cstr(...)         SBV__PROFILED(sb_append_cstr, __VA_ARGS__)
+#define sb_append_slice(...)        SBV__PROFILED(sb_append_slice, __VA_ARGS__)
+#define sb_append_sv(...)           SBV__PROFILED(sb_append_sv, __VA_ARGS__)
+#define sb_append_many(...)         SBV__PROFILED(sb_append_many, __VA_ARGS__)
+#define sb_join(...)                SBV__PROFILED(sb_join, __VA_ARGS__)
+#define sb_append_char(...)         SBV__PROFILED(sb_append_char, __VA_ARGS__)
+#define sb_append_null(...)         SBV__PROFILED(sb_append_null, __VA_ARGS__)
+#define sb_append_file(...)         SBV__PROFILED(sb_append_file, __VA_ARGS__)
+#define sb_append_cstr_z(...)       SBV__PROFILED(sb_append_cstr_z, __VA_ARGS__)
+#define sb_append_slice_z(...)      SBV__PROFILED(sb_append_slice_z, __VA_ARGS__)
+#define sb_append_sv_z(...)         SBV__PROFILED(sb_append_sv_z, __VA_ARGS__)
+#define sb_append_file_z(...)       SBV__PROFILED(sb_append_file_z, __VA_ARGS__)
+#define sb_extract_z(...)           SBV__PROFILED(sb_extract_z, __VA_ARGS__)
+#define sb_extract_slice_z(...)     SBV__PROFILED(sb_extract_slice_z, __VA_ARGS__)
+#define sv_extract_z(...)           SBV__PROFILED(sv_extract_z, __VA_ARGS__)
+#define sb_pop(...)                 SBV__PROFILED(sb_pop, __VA_ARGS__)
+#define sb_pop_z(...)               SBV__PROFILED(sb_pop_z, __VA_ARGS__)
+#define sb_extract(...)             SBV__PROFILED(sb_extract, __VA_ARGS__)
+#define sb_extract_slice(...)       SBV__PROFILED(sb_extract_slice, __VA_ARGS__)
+#define sb_to_cstr(...)             SBV__PROFILED(sb_to_cstr, __VA_ARGS__)
+#define sb_detach(...)              SBV__PROFILED(sb_detach, __VA_ARGS__)
+#define sb_reserve(...)             SBV__PROFILED(sb_reserve, __VA_ARGS__)
+#define sb_shrink_to_fit(...)       SBV__PROFILED(sb_shrink_to_fit, __VA_ARGS__)
+#define sb_free(...)                SBV__PROFILED(sb_free, __VA_ARGS__)
+#ifdef SBV_POOL
+#define sb_pool_acquire(...)        SBV__PROFILED(sb_pool_acquire, __VA_ARGS__)
+#endif // SBV_POOL
+
+#define sv_from_cstr(...)           SBV__PROFILED(sv_from_cstr, __VA_ARGS__)
+#define sv_from_format(...)         SBV__PROFILED(sv_from_format, __VA_ARGS__)
+#define sv_from_vformat(...)        SBV__PROFILED(sv_from_vformat, __VA_ARGS__)
+#define sv_equals(...)              SBV__PROFILED(sv_equals, __VA_ARGS__)
+#define sv_equals_case(...)         SBV__PROFILED(sv_equals_case, __VA_ARGS__)
+#define sv_compare(...)             SBV__PROFILED(sv_compare, __VA_ARGS__)
+#define sv_compare_case(...)        SBV__PROFILED(sv_compare_case, __VA_ARGS__)
+#define sv_starts_with(...)         SBV__PROFILED(sv_starts_with, __VA_ARGS__)
+#define sv_starts_with_case(...)    SBV__PROFILED(sv_starts_with_case, __VA_ARGS__)
+#define sv_ends_with(...)           SBV__PROFILED(sv_ends_with, __VA_ARGS__)
+#define sv_ends_with_case(...)      SBV__PROFILED(sv_ends_with_case, __VA_ARGS__)
+#define sv_find(...)                SBV__PROFILED(sv_find, __VA_ARGS__)
+#define sv_find_case(...)           SBV__PROFILED(sv_find_case, __VA_ARGS__)
+#define sv_find_char(...)           SBV__PROFILED(sv_find_char, __VA_ARGS__)
+#define sv_count(...)               SBV__PROFILED(sv_count, __VA_ARGS__)
+#define sv_count_case(...)          SBV__PROFILED(sv_count_case, __VA_ARGS__)
+#define sv_count_char(...)          SBV__PROFILED(sv_count_char, __VA_ARGS__)
+#define sv_contains(...)            SBV__PROFILED(sv_contains, __VA_ARGS__)
+#define sv_contains_case(...)       SBV__PROFILED(sv_contains_case, __VA_ARGS__)
+#define sv_contains_char(...)       SBV__PROFILED(sv_contains_char, __VA_ARGS__)
+#define sv_split(...)               SBV__PROFILED(sv_split, __VA_ARGS__)
+#define sv_split_case(...)          SBV__PROFILED(sv_split_case, __VA_ARGS__)
+#define sv_split_char(...)          SBV__PROFILED(sv_split_char, __VA_ARGS__)
+#define sv_split_count(...)         SBV__PROFILED(sv_split_count, __VA_ARGS__)
+#define sv_split_case_count(...)    SBV__PROFILED(sv_split_case_count, __VA_ARGS__)
+#define sv_split_char_count(...)    SBV__PROFILED(sv_split_char_count, __VA_ARGS__)
+#define sv_trim(...)                SBV__PROFILED(sv_trim, __VA_ARGS__)
+#define sv_trim_chars(...)          SBV__PROFILED(sv_trim_chars, __VA_ARGS__)
+#define sv_trim_seq(...)            SBV__PROFILED(sv_trim_seq, __VA_ARGS__)
+#define sv_trim_left(...)           SBV__PROFILED(sv_trim_left, __VA_ARGS__)
+#define sv_trim_left_chars(...)     SBV__PROFILED(sv_trim_left_chars, __VA_ARGS__)
+#define sv_trim_left_seq(...)       SBV__PROFILED(sv_trim_left_seq, __VA_ARGS__)
+#define sv_trim_right(...)          SBV__PROFILED(sv_trim_right, __VA_ARGS__)
+#define sv_trim_right_chars(...)    SBV__PROFILED(sv_trim_right_chars, __VA_ARGS__)
+#define sv_trim_right_seq(...)      SBV__PROFILED(sv_trim_right_seq, __VA_ARGS__)
+#define sv_append(...)              SBV__PROFILED(sv_append, __VA_ARGS__)
+#define sv_append_many(...)         SBV__PROFILED(sv_append_many, __VA_ARGS__)
+#define sv_append_many_len(...)     SBV__PROFILED(sv_append_many_len, __VA_ARGS__)
+#define sv_join(...)                SBV__PROFILED(sv_join, __VA_ARGS__)
+#define sv_join_len(...)            SBV__PROFILED(sv_join_len, __VA_ARGS__)
+#define sv_replace(...)             SBV__PROFILED(sv_replace, __VA_ARGS__)
+#define sv_replace_len(...)         SBV__PROFILED(sv_replace_len, __VA_ARGS__)
+#define sv_extract(...)             SBV__PROFILED(sv_extract, __VA_ARGS__)
+#define sv_to_cstr(...)             SBV__PROFILED(sv_to_cstr, __VA_ARGS__)
+
+#ifdef SBV_THREADS
+#define sv_reader_next(...)         SBV__PROFILED(sv_reader_next, __VA_ARGS__)
+#define sv_sort_parallel(...)       SBV__PROFILED(sv_sort_parallel, __VA_ARGS__)
+#define sv_sort_case_parallel(...)  SBV__PROFILED(sv_sort_case_parallel, __VA_ARGS__)
+#endif // SBV_THREADS
+#define sv_sort(...)                SBV__PROFILED(sv_sort, __VA_ARGS__)
+#define sv_sort_case(...)           SBV__PROFILED(sv_sort_case, __VA_ARGS__)
+#define sv_dedup(...)               SBV__PROFILED(sv_dedup, __VA_ARGS__)
+#define sv_dedup_case(...)          SBV__PROFILED(sv_dedup_case, __VA_ARGS__)
+
+#define sb_concurrent_append(...)   SBV__PROFILED(sb_concurrent_append, __VA_ARGS__)
+#define sb_concurrent_appendf(...)  SBV__PROFILED(sb_concurrent_appendf, __VA_ARGS__)
+#define sb_concurrent_vappendf(...) SBV__PROFILED(sb_concurrent_vappendf, __VA_ARGS__)
+
+#define sv_glob_match(...)          SBV__PROFILED(sv_glob_match, __VA_ARGS__)
+#define sv_glob_match_many(...)     SBV__PROFILED(sv_glob_match_many, __VA_ARGS__)
+#define sv_edit_distance(...)       SBV__PROFILED(sv_edit_distance, __VA_ARGS__)
+#define sv_edit_distance_bounded(...) SBV__PROFILED(sv_edit_distance_bounded, __VA_ARGS__)
+#define sv_find_approx(...)         SBV__PROFILED(sv_find_approx, __VA_ARGS__)
+#define sv_trie_longest(...)        SBV__PROFILED(sv_trie_longest, __VA_ARGS__)
+#define sv_trie_all(...)            SBV__PROFILED(sv_trie_all, __VA_ARGS__)
+#define sv_trie_exact(...)          SBV__PROFILED(sv_trie_exact, __VA_ARGS__)
+#define sb_template_render(...)     SBV__PROFILED(sb_template_render, __VA_ARGS__)
+#define sv_schema_extract(...)      SBV__PROFILED(sv_schema_extract, __VA_ARGS__)
+#define sb_gap_insert(...)          SBV__PROFILED(sb_gap_insert, __VA_ARGS__)
+#define sb_gap_erase(...)           SBV__PROFILED(sb_gap_erase, __VA_ARGS__)
+#define sb_gap_replace(...)         SBV__PROFILED(sb_gap_replace, __VA_ARGS__)
+#define sb_to_lower(...)            SBV__PROFILED(sb_to_lower, __VA_ARGS__)
+#define sb_to_upper(...)            SBV__PROFILED(sb_to_upper, __VA_ARGS__)
+#define sv_to_lower(...)            SBV__PROFILED(sv_to_lower, __VA_ARGS__)
+#define sv_to_upper(...)            SBV__PROFILED(sv_to_upper, __VA_ARGS__)
+#define sb_append_lower(...)        SBV__PROFILED(sb_append_lower, __VA_ARGS__)
+#define sb_append_upper(...)        SBV__PROFILED(sb_append_upper, __VA_ARGS__)
+#define sb_translate(...)           SBV__PROFILED(sb_translate, __VA_ARGS__)
+#define sv_translate(...)           SBV__PROFILED(sv_translate, __VA_ARGS__)
+#define sb_append_translated(...)   SBV__PROFILED(sb_append_translated, __VA_ARGS__)
+#define sv_lines_build(...)         SBV__PROFILED(sv_lines_build, __VA_ARGS__)
+#define sv_lines_extend(...)        SBV__PROFILED(sv_lines_extend, __VA_ARGS__)
+
+#define sb_append_json_escaped(...) SBV__PROFILED(sb_append_json_escaped, __VA_ARGS__)
+#define sb_append_url_encoded(...)  SBV__PROFILED(sb_append_url_encoded, __VA_ARGS__)
+#define sb_append_c_escaped(...)    SBV__PROFILED(sb_append_c_escaped, __VA_ARGS__)
+#define sb_append_shell_escaped(...) SBV__PROFILED(sb_append_shell_escaped, __VA_ARGS__)
+#define sb_append_url_decoded(...)  SBV__PROFILED(sb_append_url_decoded, __VA_ARGS__)
+#define sb_append_c_unescaped(...)  SBV__PROFILED(sb_append_c_unescaped, __VA_ARGS__)
+#define sb_append_base64_encoded(...) SBV__PROFILED(sb_append_base64_encoded, __VA_ARGS__)
+#define sb_append_hex_encoded(...)  SBV__PROFILED(sb_append_hex_encoded, __VA_ARGS__)
+#define sb_append_base64_decoded(...) SBV__PROFILED(sb_append_base64_decoded, __VA_ARGS__)
+#define sb_append_hex_decoded(...)  SBV__PROFILED(sb_append_hex_decoded, __VA_ARGS__)
+
+#endif // SBV_PROFILE